@@ -0,0 +1,94 @@
+#!/bin/bash
+
+# Conversion speed, output size and read
+# speed for a set of write path settings
+#
+# $ ./benchmark.sh /path/to/wave_0.dat [threads]
+#
+# TTree (vector and array ADC) and RNTuple
+# (-b N, WITH_RNTUPLE builds of dat_to_root
+# and cook_raw) outputs side by side
+#
+# read MB/s is cook_raw's raw read rate
+# for each output (scalars only cooked
+# output, one thread, no read-ahead),
+# left blank if cook_raw is not built
+
+echo " -------------------------------"
+date
+echo "running"
+echo "benchmark.sh"
+echo " -------------------------------"
+
+DAT_TO_ROOT=$(dirname $0)/dat_to_root
+COOK_RAW=$(realpath $(dirname $0)/../Cooking/cook_raw)
+
+FILE_PATH=$1
+THREADS=${2:-$(nproc)}
+
+if [ ! -f "${FILE_PATH}" ]; then
+    echo " usage: benchmark.sh /path/to/wave_0.dat [threads]"
+    exit 1
+fi
+
+ROOT_PATH=$(realpath ${FILE_PATH}).root
+
+# cook_raw plots go here
+WORK_DIR=$(mktemp -d)
+
+# label | dat_to_root options
+# (vector 'V' and array 'A' ADC layouts
+#  in pairs at the same compression)
+SETTINGS=(
+    "default|"
+    "array|-l A"
+    "zlib-1|-c Z -z 1"
+    "lz4-4|-c L -z 4"
+    "array-lz4-4|-l A -c L -z 4"
+    "zstd-5|-c S -z 5"
+    "lzma-5|-c X -z 5"
+    "none|-z 0"
+    "array-none|-l A -z 0"
+    "default-mt|-t ${THREADS}"
+    "lz4-4-mt|-c L -z 4 -t ${THREADS}"
+    "zstd-5-mt|-c S -z 5 -t ${THREADS}"
+    "array-zstd-5-mt|-l A -c S -z 5 -t ${THREADS}"
+    "zstd-5-mt-64MB|-c S -z 5 -s 64 -t ${THREADS}"
+    "rntuple|-b N"
+    "rntuple-lz4-4|-b N -c L -z 4"
+    "rntuple-zstd-5-mt|-b N -c S -z 5 -t ${THREADS}"
+)
+
+printf "\n %-18s %10s %12s %10s \n" "setting" "MB/s" "size (MB)" "read MB/s"
+
+for SETTING in "${SETTINGS[@]}"; do
+    LABEL=${SETTING%%|*}
+    OPTIONS=${SETTING#*|}
+
+    OUTPUT=$(${DAT_TO_ROOT} ${FILE_PATH} ${OPTIONS} 2>&1)
+
+    # -b N falls back to TTree without
+    # a WITH_RNTUPLE build
+    if [[ "${OPTIONS}" == *"-b N"* ]] && ! echo "${OUTPUT}" | grep -q "reader, RNTuple"; then
+	printf " %-18s %10s \n" "${LABEL}" "n/a (build dat_to_root WITH_RNTUPLE=1)"
+	continue
+    fi
+
+    RATE=$(echo "${OUTPUT}" | sed -n 's/.*( \(.*\) MB\/s ).*/\1/p' | tail -1)
+    SIZE=$(echo "${OUTPUT}" | sed -n 's/.*output file size \(.*\) MB.*/\1/p' | tail -1)
+
+    READ=""
+
+    if [ -x "${COOK_RAW}" ] && [ -f "${ROOT_PATH}" ]; then
+	READ=$(cd ${WORK_DIR} && ${COOK_RAW} ${ROOT_PATH} -a S -v H -f 0 -w N 2>/dev/null | \
+		   sed -n 's/.*Read .* ( \(.*\) MB\/s ).*/\1/p' | tail -1)
+    fi
+
+    printf " %-18s %10s %12s %10s \n" "${LABEL}" "${RATE}" "${SIZE}" "${READ}"
+done
+
+rm -rf ${WORK_DIR}
+
+echo " ------------------------------"
+date
+echo " ------------------------------"
@@ -1,7 +1,7 @@
 /***************************************************
  * A program to process wavedump binary output files
  * 
- * VME version
+ * VME and desktop (x742) digitisers
  *
  * Author 
  *  gary.smith@ed.ac.uk
@@ -23,32 +23,159 @@
  *  Option 1: 
  *  $ ./dat_to_root wave_0.dat
  * 
+ *  Option 2: stream reader (no memory mapping)
+ *  $ ./dat_to_root wave_0.dat -r s
+ * 
+ *  Option 3: all channels of a run, 4 files at a time
+ *  $ ./dat_to_root /path/to/run/ -j 4
+ *  $ ./dat_to_root wave_0.dat wave_1.dat wave_2.dat
+ * 
+ *  Option 4: fixed length ADC array branch
+ *  $ ./dat_to_root wave_0.dat -l A
+ * 
+ *  Option 5: RNTuple output (build with WITH_RNTUPLE=1)
+ *  $ ./dat_to_root wave_0.dat -b N
+ * 
+ *  Option 6: events 50000 to 51999 only 
+ *            (written to wave_0.dat.50000_51999.root)
+ *  $ ./dat_to_root wave_0.dat -f 50000 -n 2000
+ * 
+ *  Option 7: write the event index sidecar (wave_0.dat.idx)
+ *  $ ./dat_to_root wave_0.dat -i Y
+ * 
+ *  Option 8: LZ4 level 4, 32 MB clusters, 
+ *            compression on 8 threads
+ *  $ ./dat_to_root wave_0.dat -c L -z 4 -s 32 -t 8
+ * 
+ *  (benchmark.sh tabulates MB/s and output 
+ *   size for a set of these settings)
+ * 
+ *  Option 9: follow files that wavedump is still writing,
+ *            saving the output every 60 s and finishing 
+ *            once the files have not grown for 120 s
+ *  $ ./dat_to_root /path/to/run/ -w 120 -u 60
+ * 
+ *  Option 10: desktop digitiser (32 bit float samples)
+ *  $ ./dat_to_root wave_0.dat -d D
+ * 
  * Input - 
  *  binary file written by CAEN's 
  *  wavedump software
  * 
- * Output - a root file (e.g. wave_0.dat.root) containing
+ *  The file is memory mapped and each event is 
+ *  sliced out of the mapping using HEAD[0] 
+ *  (see $WM_COMMON/WaveDumpReader.h), falling back
+ *  to buffered stream reads if mapping fails
+ * 
+ *  Desktop samples are rounded and narrowed to 
+ *  16 bits (see $WM_COMMON/SampleDecoder.h), HEAD
+ *  is stored as written
+ * 
+ *  Converting a range of events uses the event
+ *  index (wave_0.dat.idx), which is built with one 
+ *  header-only scan if it does not already exist
+ * 
+ *  Compression runs on the -t threads of ROOT's
+ *  implicit multi-threading (branch baskets of a
+ *  TTree, pages of an RNTuple) while this thread
+ *  decodes the next events. The thread pool is
+ *  one per process, shared by all the files
+ *  being converted (-j workers), not -t per file
+ * 
+ *  A directory argument is expanded to all the
+ *  wave_*.dat files it contains. Files are converted
+ *  in parallel on a pool of -j workers 
+ *  (default: one per core, at most one per file)
+ * 
+ * Output - a root file per input (e.g. wave_0.dat.root) containing
  *  unsigned int HEAD[6]  6 * 32 bits = 24  bytes 
  *  std::vector<short> ADC(N)  N * 16 bits = 16N bytes (N = No. samples) 
+ *   or, with -l A,
+ *  short ADC[N]  (see $WM_COMMON/ADCBranch.h)
+ *  stored as TTree 'T' or, with -b N, RNTuple 'T' 
+ *  (see $WM_COMMON/DataStore.h)
  * 
  * Dependencies
  *  The cern developed root framework
  *  Makefile (included) which uses g++ compiler
+ *  WaveDumpReader.C - $WM_COMMON 
+ *  DataStore.C      - $WM_COMMON 
  *
  */ 
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdlib>
-#include <fstream>
+#include <climits>
 #include <iostream>
+#include <thread>
 #include <vector>
 
+#include <dirent.h>
+#include <sys/stat.h>
+
 #include "TFile.h"
 #include "TTree.h"
 
 #include "TROOT.h"
+#include "Compression.h"
+
+#include "WaveDumpReader.h"
+#include "DataStore.h"
+#include "ReadNumber.h"
 
 using namespace std;
 
+struct ConvOptions {
+  // 'm' memory mapped (default)
+  // 's' stream reads
+  char reader    = 'm';
+  // 'V' VME (default)
+  // 'D' desktop
+  char digitiser = 'V';
+  // 'V' vector (default)
+  // 'A' fixed length array
+  char layout    = 'V';
+  // 'T' TTree (default)
+  // 'N' RNTuple
+  char backend   = 'T';
+  // 'Y' write event index sidecar
+  char index     = 'N';
+  // events to convert (nEvents < 0 for all)
+  long long firstEvent = 0;
+  long long nEvents    = -1;
+  // compression codec 'Z' zlib, 'L' LZ4,
+  // 'X' LZMA, 'S' ZSTD, 0 for ROOT default
+  char codec     = 0;
+  int  level     = -1;
+  StoreOptions store;
+  // follow mode: finish once the file has not
+  // grown for followSecs (0 - no follow),
+  // saving the output every saveSecs
+  int  followSecs = 0;
+  int  saveSecs   = 60;
+  int  verbosity = 1;
+};
+
+struct ConvStats {
+  int       nEntries = 0;
+  long long nBytes   = 0;
+  long long outBytes = 0;
+  double    seconds  = 0.;
+  bool      success  = false;
+};
+
+void PrintUsage();
+int  GetCompression(char codec, int level);
+bool AddInputs(string path, vector<string> * inNames);
+bool ConvertFile(string inName, ConvOptions opts,
+		 ConvStats * stats);
+bool WaitForEvent(WaveDumpReader * inFile, RawWriter * outWriter,
+		  ConvOptions opts, chrono::steady_clock::time_point * lastSave);
+void AutoSave(RawWriter * outWriter, ConvOptions opts,
+	      chrono::steady_clock::time_point * lastSave);
+
 int main(int argc, char **argv){
   
   // 0 - no printing
@@ -64,18 +191,342 @@ int main(int argc, char **argv){
     printf("\n ---------------------------------- \n" );
     
     printf("\n wavedump binary to root conversion \n" );
-    printf("          ( VME version )             \n" );
+    printf("       ( VME and desktop )            \n" );
   }
   
-  ifstream inFile(argv[1]);
+  ConvOptions opts;
+  opts.verbosity = verbosity;
   
-  if(!inFile.good()){
-    fprintf( stderr, "\n Error: check filename \n ");    
+  int  nWorkers = 0;
+  
+  // implicit MT threads for compression
+  int  nThreads = 0;
+  
+  vector<string> inNames;
+  
+  for ( int i = 1; i < argc ; i++ ) {
+    if( argv[i][0] != '-' ){
+      if( !AddInputs(argv[i],&inNames) ){
+	fprintf( stderr, "\n Error: check filename %s \n ",argv[i]);
+	return -1;
+      }
+    }
+    else if( i+1 < argc && string(argv[i]) == "-r" ) opts.reader = *argv[++i];
+    else if( i+1 < argc && string(argv[i]) == "-d" ) opts.digitiser = *argv[++i];
+    else if( i+1 < argc && string(argv[i]) == "-l" ) opts.layout = *argv[++i];
+    else if( i+1 < argc && string(argv[i]) == "-b" ) opts.backend = CheckBackend(*argv[++i]);
+    else if( i+1 < argc && string(argv[i]) == "-i" ) opts.index = *argv[++i];
+    else if( i+1 < argc && string(argv[i]) == "-c" ) opts.codec = *argv[++i];
+    else if( i+1 < argc && argv[i][1] != 0 && argv[i][2] == 0 &&
+	     string("jfnzstwu").find(argv[i][1]) != string::npos ){
+      
+      string    option = argv[i];
+      long long value  = 0;
+      
+      // -n -1 is all events, -u 0 would
+      // AutoSave after every event
+      long long min = ( option == "-n" ) ? -1 : 0;
+      
+      if( option == "-u" )
+	min = 1;
+      
+      long long max = ( option == "-f" || option == "-n" ) ? LLONG_MAX : INT_MAX;
+      
+      if( !ReadNumber(option,argv[++i],min,max,&value) ){
+	PrintUsage();
+	return -1;
+      }
+      
+      if     ( option == "-j" ) nWorkers = (int)value;
+      else if( option == "-f" ) opts.firstEvent = value;
+      else if( option == "-n" ) opts.nEvents = value;
+      else if( option == "-z" ) opts.level = (int)value;
+      else if( option == "-s" ) opts.store.clusterBytes = value*1000000LL;
+      else if( option == "-t" ) nThreads = (int)value;
+      else if( option == "-w" ) opts.followSecs = (int)value;
+      else if( option == "-u" ) opts.saveSecs = (int)value;
+    }
+    else {
+      PrintUsage();
+      return -1;
+    }
+  }
+  
+  int nFiles = (int)inNames.size();
+  
+  if( nFiles == 0 ){
+    PrintUsage();
+    return -1;
+  }
+  
+  // RNTuple fields are vectors only
+  if( opts.layout == 'A' && opts.backend == 'N' ){
+    fprintf( stderr, "\n Error: -l A (array ADC) is for TTree output only, not -b N \n ");
     return -1;
   }
   
-  string inName  = argv[1];
-  string outName = argv[1];
+  opts.store.compression = GetCompression(opts.codec,opts.level);
+  
+  if( opts.followSecs > 0 ){
+    if( opts.firstEvent > 0 || opts.nEvents >= 0 ){
+      fprintf( stderr, "\n Error: follow mode converts whole files \n ");
+      return -1;
+    }
+    
+    // all files grow together
+    nWorkers = nFiles;
+    
+    printf("\n  Following, until no new events for %d s \n",
+	   opts.followSecs);
+  }
+  
+  if( nThreads > 0 ){
+    ROOT::EnableImplicitMT(nThreads);
+    
+    if( verbosity > 0 )
+      printf("\n  Compressing on %u threads \n",
+	     ROOT::GetThreadPoolSize());
+  }
+  
+  if( nWorkers < 1 )
+    nWorkers = (int)thread::hardware_concurrency();
+  if( nWorkers < 1 )
+    nWorkers = 1;
+  if( nWorkers > nFiles )
+    nWorkers = nFiles;
+
+  // per-event printing only makes 
+  // sense for one file at a time
+  if( nWorkers > 1 ){
+    ROOT::EnableThreadSafety();
+    opts.verbosity = 0;
+    
+    printf("\n  Converting %d files with %d workers \n",
+	   nFiles, nWorkers);
+  }
+  
+  vector<ConvStats> stats(nFiles);
+  atomic<int> nextFile(0);
+  
+  auto startClock = chrono::steady_clock::now();
+  
+  auto worker = [&](){
+    for( int iFile = nextFile++; iFile < nFiles; iFile = nextFile++ ){
+      ConvertFile(inNames[iFile],opts,&stats[iFile]);
+      
+      if( nWorkers < 2 )
+	continue;
+      
+      // no rate for a file not converted
+      if( !stats[iFile].success || stats[iFile].seconds <= 0. )
+	fprintf( stderr, "\n Error: %s not converted \n ",
+		 inNames[iFile].c_str());
+      else
+	printf("\n  %s \n   %d entries  %.1f MB in %.1f s ( %.1f MB/s ) \n",
+	       inNames[iFile].c_str(),stats[iFile].nEntries,
+	       stats[iFile].nBytes/1.0E6,stats[iFile].seconds,
+	       stats[iFile].nBytes/1.0E6/stats[iFile].seconds);
+    }
+  };
+  
+  vector<thread> workers;
+  
+  for( int iWorker = 1; iWorker < nWorkers; iWorker++ )
+    workers.emplace_back(worker);
+  
+  worker();
+  
+  for( auto & w : workers )
+    w.join();
+  
+  double seconds = chrono::duration<double>(chrono::steady_clock::now() - 
+					    startClock).count();
+  
+  long long nBytes  = 0;
+  int       nFailed = 0;
+
+  for( auto & st : stats ){
+    nBytes += st.nBytes;
+    if( !st.success ) 
+      nFailed++;
+  }
+  
+  if( nFiles > 1 ){
+    printf("\n ---------------------------------- \n" );
+    printf("\n  %d files converted ( %d failed ) \n",nFiles-nFailed,nFailed);
+    if( nBytes > 0 && seconds > 0. )
+      printf("\n  %.1f MB in %.1f s ( %.1f MB/s ) \n",
+	     nBytes/1.0E6, seconds, nBytes/1.0E6/seconds);
+    printf("\n ---------------------------------- \n" );
+  }
+  
+  if( nFailed > 0 )
+    return -1;
+  
+  return 1;
+}
+
+// follow mode: true once the whole of the next
+// event has been written, false if the file has
+// not grown for opts.followSecs
+bool WaitForEvent(WaveDumpReader * inFile, RawWriter * outWriter,
+		  ConvOptions opts, chrono::steady_clock::time_point * lastSave){
+  
+  auto lastGrowth = chrono::steady_clock::now();
+  
+  while( !inFile->IsEventComplete() ){
+    
+    auto now = chrono::steady_clock::now();
+    
+    if( inFile->Refresh() )
+      lastGrowth = now;
+    else if( now - lastGrowth > chrono::seconds(opts.followSecs) )
+      return false;
+    else
+      this_thread::sleep_for(chrono::milliseconds(500));
+    
+    // output is complete up to the last event
+    AutoSave(outWriter,opts,lastSave);
+  }
+  
+  return true;
+}
+
+void AutoSave(RawWriter * outWriter, ConvOptions opts,
+	      chrono::steady_clock::time_point * lastSave){
+  
+  auto now = chrono::steady_clock::now();
+  
+  if( now - *lastSave < chrono::seconds(opts.saveSecs) )
+    return;
+  
+  outWriter->AutoSave();
+  
+  *lastSave = now;
+}
+
+// ROOT compression setting (algorithm*100 + level)
+// or -1 to keep the ROOT default
+int GetCompression(char codec, int level){
+  
+  using namespace ROOT::RCompressionSetting;
+  
+  EAlgorithm::EValues algorithm = EAlgorithm::kUseGlobal;
+  
+  switch( codec ){
+  case 0  : break;
+  case 'Z': algorithm = EAlgorithm::kZLIB; break;
+  case 'L': algorithm = EAlgorithm::kLZ4;  break;
+  case 'X': algorithm = EAlgorithm::kLZMA; break;
+  case 'S': algorithm = EAlgorithm::kZSTD; break;
+  default :
+    fprintf( stderr, "\n Error: unknown codec '%c' \n ",codec);
+    fprintf( stderr, "\n Setting to default \n ");
+  }
+  
+  if( algorithm == EAlgorithm::kUseGlobal && level < 0 )
+    return -1;
+  
+  // ROOT's default level for the codec
+  if( level < 0 )
+    level = 4;
+  if( level > 9 )
+    level = 9;
+  
+  if( algorithm == EAlgorithm::kUseGlobal )
+    return level;
+  
+  return ROOT::CompressionSettings(algorithm,level);
+}
+
+// add path if it is a file or all the 
+// wave_*.dat files in it if it is a directory
+bool AddInputs(string path, vector<string> * inNames){
+  
+  struct stat st;
+  
+  if( stat(path.c_str(),&st) != 0 )
+    return false;
+  
+  if( !S_ISDIR(st.st_mode) ){
+    inNames->push_back(path);
+    return true;
+  }
+  
+  if( path.back() != '/' )
+    path += "/";
+  
+  DIR * dir = opendir(path.c_str());
+  
+  if( !dir )
+    return false;
+  
+  vector<string> names;
+  
+  while( struct dirent * entry = readdir(dir) ){
+    string name = entry->d_name;
+    if( name.rfind("wave_",0) == 0 &&
+	name.size() > 4 && 
+	name.compare(name.size()-4,4,".dat") == 0 )
+      names.push_back(path + name);
+  }
+  
+  closedir(dir);
+  
+  sort(names.begin(),names.end());
+  
+  inNames->insert(inNames->end(),names.begin(),names.end());
+  
+  return !names.empty();
+}
+
+bool ConvertFile(string inName, ConvOptions opts,
+		 ConvStats * stats){
+  
+  int verbosity = opts.verbosity;
+  
+  auto startClock = chrono::steady_clock::now();
+  
+  WaveDumpReader inFile;
+  
+  if(!inFile.Open(inName,opts.reader!='s',opts.digitiser)){
+    fprintf( stderr, "\n Error: check filename \n ");    
+    return false;
+  }
+  
+  bool isRange = ( opts.firstEvent > 0 || opts.nEvents >= 0 );
+  
+  // random access (and variable event size) 
+  // needs the offset of every event
+  if( isRange || opts.index == 'Y' ){
+    if( !inFile.LoadIndex() ){
+      fprintf( stderr, "\n Error: no events indexed \n ");
+      return false;
+    }
+    if( verbosity > 0 )
+      printf("\n %lld events indexed in %s \n",
+	     inFile.GetNEvents(),inFile.GetIndexPath().c_str());
+  }
+  
+  long long lastEvent = inFile.GetNEvents() - 1;
+  
+  if( opts.nEvents >= 0 && 
+      opts.firstEvent + opts.nEvents - 1 < lastEvent )
+    lastEvent = opts.firstEvent + opts.nEvents - 1;
+  
+  if( isRange && !inFile.SeekEvent(opts.firstEvent) ){
+    fprintf( stderr, "\n Error: first event %lld out of range \n ",
+	     opts.firstEvent);
+    return false;
+  }
+  
+  string outName = inName;
+  
+  // do not overwrite a full conversion
+  if( isRange )
+    outName += "." + to_string(opts.firstEvent) +
+      "_" + to_string(lastEvent);
+  
   outName += ".root";
   
   if( verbosity > 0 ){
@@ -89,8 +540,9 @@ int main(int argc, char **argv){
   TFile * outFile = new TFile(outName.c_str(),
 			      "RECREATE",
 			      inName.c_str());
-   
-  TTree * outTree = new TTree("T","T");
+  
+  if( opts.store.compression >= 0 )
+    outFile->SetCompressionSettings(opts.store.compression);
 
   unsigned int HEAD[6];
   unsigned int NS = 0; 
@@ -100,54 +552,44 @@ int main(int argc, char **argv){
   unsigned int EC = 0; // Event Counter
   //unsigned int TT = 0; // Trigger Time Tag
   
-  short buffer   = 0;
-
   int nEntries   = 0;
   int firstEntry = 0;
   int lastEntry  = -1;
   
-  outTree->Branch("HEAD",HEAD,"HEAD[6]/i");
-  
-  inFile.seekg(0, ios::beg);
-  for (int i = 0 ; i < 6 ; i++ ) 
-    inFile.read((char*)&HEAD[i],sizeof(int));
-  
   // HEAD[0] is event size in bytes 
   // (header plus samples)
-  NS = (HEAD[0] - 24)/2;
+  NS = inFile.GetNSamples();
   
-  if( verbosity > 1)
-    for (int i = 0 ; i < 6 ; i++ )
-      printf("\n HEAD[%d] %u \n",i,HEAD[i]);
+  // sized for the array layout, which 
+  // binds the branch to ADC's buffer
+  std::vector<short> ADC(NS);
   
-  std::vector<short> ADC;
+  RawWriter * outWriter = RawWriter::Create(opts.backend,outFile,
+					    HEAD,&ADC,opts.layout,
+					    opts.store);
   
-  outTree->Branch("ADC",&ADC);
+  long long nToRead = lastEvent - opts.firstEvent + 1;
   
-  inFile.seekg(0, ios::beg);
-  while ( inFile.is_open() && 
- 	  inFile.good()    && 
- 	  !inFile.eof()      ){
+  auto lastSave = chrono::steady_clock::now();
+  
+  // reader stops at the last complete event
+  // (in follow mode, waits for the next one)
+  while ( (!isRange || nToRead-- > 0) &&
+	  ( inFile.NextEvent(HEAD,&ADC) ||
+	    ( opts.followSecs > 0 &&
+	      WaitForEvent(&inFile,outWriter,opts,&lastSave) &&
+	      inFile.NextEvent(HEAD,&ADC) ) ) ){
     
-    //------------------
-    // header is six lots 32 bits    
-    for (int i = 0 ; i < 6 ; i++ )
-      inFile.read((char*)&HEAD[i],sizeof(int)); 
-      
-    // HEAD[0] is event size in bytes
-    // (header plus samples)
-    if( ( (HEAD[0] - 24)/2 ) != NS )
-      fprintf( stderr, "\n Error: Number of Samples has changed \n ");    
-
-    ADC.clear();
-
-    //------------------
-    // waveform is N lots of 16 bits    
-    for (int i = 0; i < (int)NS ; i++){
-      inFile.read((char*)&buffer,sizeof(short));     
-      ADC.push_back(buffer);
+    if( opts.layout == 'A' && ADC.size() != NS ){
+      fprintf( stderr, "\n Error: event skipped, fixed length ADC layout \n ");
+      ADC.resize(NS);
+      continue;
     }
     
+    if( verbosity > 1 && nEntries==0 )
+      for (int i = 0 ; i < 6 ; i++ )
+	printf("\n HEAD[%d] %u \n",i,HEAD[i]);
+    
     ID = HEAD[1]; // Board ID
     PN = HEAD[2]; // Pattern (VME)
     CL = HEAD[3]; // Channel
@@ -171,36 +613,101 @@ int main(int argc, char **argv){
 	for (int i = 0 ; i < (int)NS ; i++)
 	  printf("\n ADC[%d] = %d \n",i,ADC.at(i));
     }
-    else if ( (NS <= 1000  && EC%500000 == 0) ||
-	      (NS >  1000  && EC%50000  == 0) ){
+    else if ( verbosity > 0 &&
+	      ( (NS <= 1000  && EC%500000 == 0) ||
+		(NS >  1000  && EC%50000  == 0) ) ){
       printf("\n  Entry         %d \n", EC);
     }
 
-    // skip last iteration as it  
-    // takes previous event values
-    if( (int)EC == lastEntry){
-      break;
-    }
-    
     lastEntry = EC;
     
     nEntries++;
   
-    outTree->Fill();
+    outWriter->Fill();
+    
+    if( opts.followSecs > 0 )
+      AutoSave(outWriter,opts,&lastSave);
     
   } // end: while loop
   
-  printf("\n  Last Entry    %d \n", lastEntry);
-  printf("\n  Total Entries %d \n", nEntries);
-  printf("\n ---------------------------------- \n" );
+  // wavedump was stopped mid-event
+  if( !isRange && 
+      inFile.GetBytesRead() < inFile.GetFileSize() )
+    fprintf( stderr, "\n Warning: incomplete final event ignored \n ");
   
-  outTree->Write();
-  outTree->Delete();
+  if( verbosity > 0 ){
+    printf("\n  Last Entry    %d \n", lastEntry);
+    printf("\n  Total Entries %d \n", nEntries);
+  }
+  
+  outWriter->Write();
+  delete outWriter;
   
   outFile->Write();
+  
+  stats->outBytes = outFile->GetEND();
+  
   outFile->Close();
+  delete outFile;
   
-  inFile.close();	
+  stats->nEntries = nEntries;
+  stats->nBytes   = inFile.GetBytesRead() - 
+    inFile.GetEventOffset(opts.firstEvent);
+  stats->seconds  = chrono::duration<double>(chrono::steady_clock::now() - 
+					     startClock).count();
+  stats->success  = true;
   
-  return 1;
+  if( verbosity > 0 ){
+    printf("\n  %s reader, %s \n", 
+	   inFile.IsMapped() ? "mmap" : "stream",
+	   opts.backend == 'N' ? "RNTuple" :
+	   opts.layout  == 'A' ? "TTree, array ADC" : "TTree, vector ADC");
+    if( opts.store.compression >= 0 )
+      printf("\n  compression setting %d \n",
+	     opts.store.compression);
+    printf("\n  %.1f MB in %.1f s ( %.1f MB/s ) \n",
+	   stats->nBytes/1.0E6, stats->seconds, 
+	   stats->nBytes/1.0E6/stats->seconds);
+    printf("\n  output file size %.1f MB \n",
+	   stats->outBytes/1.0E6);
+    printf("\n ---------------------------------- \n" );
+  }
+  
+  inFile.Close();	
+  
+  return true;
+}
+
+void PrintUsage() {
+  cerr << " Usage: " << endl;
+  cerr << " dat_to_root /path/to/wave_0.dat [more files or run directories] [-d digitiser] [-r reader] [-j workers] [-l layout] [-b backend] [-c codec] [-z level] [-s cluster MB] [-t threads] [-f first] [-n events] [-i index] [-w seconds] [-u seconds] "
+       << endl;
+  cerr << " -d options for digitiser: 'V' VME (default), 'D' desktop "
+       << endl;
+  cerr << " -r options for reader: 'm' memory mapped (default), 's' stream reads "
+       << endl;
+  cerr << " -j number of files converted at the same time (default: number of cores) "
+       << endl;
+  cerr << " -l options for ADC branch layout: 'V' std::vector<short> (default), 'A' fixed length array (TTree only) "
+       << endl;
+  cerr << " -b options for output backend: 'T' TTree (default), 'N' RNTuple "
+       << endl;
+  cerr << " -c options for compression codec: 'Z' zlib, 'L' LZ4, 'X' LZMA, 'S' ZSTD (default: ROOT default) "
+       << endl;
+  cerr << " -z compression level 0 - 9 (0 no compression) "
+       << endl;
+  cerr << " -s cluster (auto flush) size in MB "
+       << endl;
+  cerr << " -t number of threads compressing, shared by all files (implicit MT is one pool per process, default off) "
+       << endl;
+  cerr << " -w follow files still being written, finishing when they have not grown for this many seconds "
+       << endl;
+  cerr << " -u seconds between saves of the output in follow mode, at least 1 (default 60) "
+       << endl;
+  cerr << " -f first event to convert (default 0) "
+       << endl;
+  cerr << " -n number of events to convert (default all) "
+       << endl;
+  cerr << " -i options for event index: 'Y' write wave_N.dat.idx, 'N' (default, unless -f or -n is used) "
+       << endl;
 }
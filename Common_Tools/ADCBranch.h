@@ -0,0 +1,88 @@
+/*----------
+  PURPOSE
+  Writing and reading the 'ADC' waveform
+  branch in either of its two layouts
+
+  'V' std::vector<short>  (default)
+      per-entry length, streamed as an object
+  'A' ADC[NSamples]/S
+      fixed length array, read straight into
+      a buffer with no per-entry streaming
+      or reallocation
+
+  Readers detect the layout from the branch
+  type so files of either kind can be read.
+
+  USAGE
+  #include "ADCBranch.h"
+
+  // writing (ADC holds NSamples shorts
+  // and must not reallocate after this)
+  Branch_ADC(tree,&ADC,layout);
+
+  // reading
+  vector<short> * ADC = 0;
+  vector<short>   ADC_arr;
+  SetBranchAddress_ADC(tree,&ADC,&ADC_arr,&b_ADC);
+
+*/
+
+#ifndef ADCBranch_h
+#define ADCBranch_h
+
+#include <TTree.h>
+#include <TBranch.h>
+#include <TLeaf.h>
+
+#include <vector>
+
+using namespace std;
+
+inline TBranch * Branch_ADC(TTree * tree,
+			    vector<short> * ADC,
+			    char layout = 'V'){
+
+  if( layout != 'A' )
+    return tree->Branch("ADC",ADC);
+
+  char leafList[32];
+  sprintf(leafList,"ADC[%d]/S",(int)ADC->size());
+
+  return tree->Branch("ADC",ADC->data(),leafList);
+}
+
+// 'V' vector, 'A' array, 0 if no ADC branch
+inline char GetLayout_ADC(TTree * tree){
+
+  TBranch * branch = tree->GetBranch("ADC");
+
+  if( !branch )
+    return 0;
+
+  if( branch->InheritsFrom("TBranchElement") )
+    return 'V';
+  else
+    return 'A';
+}
+
+// ADC points to the vector that holds
+// each entry once read, for either layout
+inline char SetBranchAddress_ADC(TTree * tree,
+				 vector<short> ** ADC,
+				 vector<short> * ADC_arr,
+				 TBranch ** b_ADC){
+
+  char layout = GetLayout_ADC(tree);
+
+  if( layout == 'V' )
+    tree->SetBranchAddress("ADC",ADC,b_ADC);
+  else if( layout == 'A' ){
+    ADC_arr->resize(tree->GetLeaf("ADC")->GetLenStatic());
+    tree->SetBranchAddress("ADC",ADC_arr->data(),b_ADC);
+    *ADC = ADC_arr;
+  }
+
+  return layout;
+}
+
+#endif
@@ -0,0 +1,349 @@
+/***************************************************
+ * Reader/writer classes for raw and cooked data
+ *
+ * Purpose
+ *  Hide the storage backend used for the raw
+ *  tree 'T' and the 'Cooked_<FileID>' tree so
+ *  that dat_to_root, TCooker and dark can use
+ *  either
+ *   'T' - TTree   (default)
+ *   'N' - RNTuple (requires WITH_RNTUPLE build)
+ *
+ *  Writers and readers are bound once to the
+ *  caller's variables, then Fill() / GetEntry()
+ *  move one event between them and the file.
+ *  Cooked readers' GetEntry() reads the scalars
+ *  only, LoadADC() the waveform of the same
+ *  entry, so that cuts on the scalars come
+ *  before any waveform is read.
+ *
+ *  Readers detect the backend from the class
+ *  of the stored object (GetBackend).
+ *
+ *  The fixed length array ADC layout ('A', see
+ *  ADCBranch.h) is for TTrees only; RNTuple
+ *  writers store vectors (cook_raw and 
+ *  dat_to_root reject -l A with -b N).
+ *
+ *  The single entry Meta_Data tree is always
+ *  a TTree.
+ *
+ *  Compression and cluster (auto flush) size
+ *  are set through StoreOptions. Compression
+ *  of a TTree follows its file's settings.
+ *
+ */
+
+#ifndef DataStore_h
+#define DataStore_h
+
+#include <TTree.h>
+#include <TFile.h>
+#include <TDirectory.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "ADCBranch.h"
+
+#ifdef WITH_RNTUPLE
+#include <RVersion.h>
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleWriter.hxx>
+#include <ROOT/RNTupleReader.hxx>
+#include <ROOT/RNTupleView.hxx>
+#include <array>
+#include <cstdint>
+
+// RNTuple left ROOT::Experimental in 6.36
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,35,0)
+namespace RNT = ROOT;
+#else
+namespace RNT = ROOT::Experimental;
+#endif
+#endif
+
+using namespace std;
+
+// 'T' TTree, 'N' RNTuple, 0 if not found
+char GetBackend(TDirectory * dir,
+		string name);
+
+// 'N' falls back to 'T' if
+// RNTuple support is not built
+char CheckBackend(char backend);
+
+// defined for WITH_RNTUPLE builds only
+class RawNTupleReader;
+
+// write path tuning (0 or -1 for backend default)
+struct StoreOptions {
+  // ROOT algorithm*100 + level, e.g. 404 LZ4 level 4
+  int       compression  = -1;
+  // entries are flushed (compressed and written)
+  // in clusters of about this many bytes
+  long long clusterBytes = 0;
+};
+
+//--------------------
+// raw data 'T'
+class RawWriter {
+public:
+  virtual ~RawWriter(){}
+
+  virtual void Fill()  = 0;
+  // write to file and release
+  virtual void Write() = 0;
+  // save the entries filled so far
+  // (file is readable mid-run for TTree,
+  //  RNTuple is only readable once written)
+  virtual void AutoSave() = 0;
+
+  // HEAD[6] and ADC are read on each Fill()
+  static RawWriter * Create(char backend,
+			    TDirectory * dir,
+			    unsigned int * HEAD,
+			    vector<short> * ADC,
+			    char layout = 'V',
+			    StoreOptions opts = StoreOptions());
+};
+
+class RawTreeWriter : public RawWriter {
+public:
+  RawTreeWriter(TDirectory * dir,
+		unsigned int * HEAD,
+		vector<short> * ADC,
+		char layout,
+		StoreOptions opts = StoreOptions());
+
+  void Fill();
+  void Write();
+  void AutoSave();
+
+  TTree * GetTree();
+
+private:
+  TTree         * fTree;
+
+  // array layout binds the vector's buffer
+  vector<short> * fADC;
+  short         * fADC_addr;
+  char            fLayout;
+};
+
+#ifdef WITH_RNTUPLE
+class RawNTupleWriter : public RawWriter {
+public:
+  RawNTupleWriter(TDirectory * dir,
+		  unsigned int * HEAD,
+		  vector<short> * ADC,
+		  StoreOptions opts = StoreOptions());
+
+  void Fill();
+  void Write();
+  void AutoSave();
+
+private:
+  unsigned int  * fHEAD_in;
+  vector<short> * fADC_in;
+
+  shared_ptr<array<unsigned int,6>> fHEAD;
+  shared_ptr<vector<short>>         fADC;
+
+  unique_ptr<RNT::RNTupleWriter>    fWriter;
+};
+
+// raw RNTuple written by dat_to_root -b N
+class RawNTupleReader {
+public:
+  RawNTupleReader(TDirectory * dir);
+  // independent reader of the same file
+  // (one per thread)
+  RawNTupleReader(string fileName);
+
+  bool      IsOpen();
+  long long GetEntries();
+  string    GetFileName();
+
+  // ADC = nullptr reads header only
+  bool      GetEntry(long long entry,
+		     unsigned int * HEAD,
+		     vector<short> * ADC);
+
+private:
+  using HeadView = decltype(declval<RNT::RNTupleReader&>().GetView<array<unsigned int,6>>(""));
+  using ADCView  = decltype(declval<RNT::RNTupleReader&>().GetView<vector<short>>(""));
+
+  string                         fFileName;
+
+  unique_ptr<RNT::RNTupleReader> fReader;
+  unique_ptr<HeadView>           fHEAD;
+  unique_ptr<ADCView>            fADC;
+};
+#endif
+
+//--------------------
+// cooked data 'Cooked_<FileID>'
+
+// addresses of the cooked variables
+// of one event (writer or reader side)
+struct CookedVars {
+  float * peak_mV   = nullptr;
+  short * peak_samp = nullptr;
+  float * min_mV    = nullptr;
+  float * mean_mV   = nullptr;
+  float * start_s   = nullptr;
+  float * base_mV   = nullptr;
+
+  // entry of the raw tree 'T', optional
+  // (-1 on reading files without it)
+  long long * raw_entry = nullptr;
+
+  // writer: read from *ADC, no ADC
+  //         branch if nullptr
+  // reader: *ADC is set to the
+  //         vector holding the waveform
+  //         once LoadADC() has read it
+  //         (left unset, or empty, if the
+  //          file has no waveforms)
+  vector<short> ** ADC = nullptr;
+};
+
+class CookedWriter {
+public:
+  virtual ~CookedWriter(){}
+
+  virtual void Fill()  = 0;
+  virtual void Write() = 0;
+
+  static CookedWriter * Create(char backend,
+			       TDirectory * dir,
+			       string name,
+			       CookedVars vars,
+			       char layout = 'V');
+};
+
+class CookedTreeWriter : public CookedWriter {
+public:
+  CookedTreeWriter(TDirectory * dir,
+		   string name,
+		   CookedVars vars,
+		   char layout);
+
+  void Fill();
+  void Write();
+
+  TTree * GetTree();
+
+private:
+  TTree         * fTree;
+
+  vector<short> * fADC;
+  short         * fADC_addr;
+  char            fLayout;
+};
+
+#ifdef WITH_RNTUPLE
+class CookedNTupleWriter : public CookedWriter {
+public:
+  CookedNTupleWriter(TDirectory * dir,
+		     string name,
+		     CookedVars vars);
+
+  void Fill();
+  void Write();
+
+private:
+  CookedVars fVars;
+
+  shared_ptr<float>          fPeak_mV;
+  shared_ptr<short>          fPeak_samp;
+  shared_ptr<float>          fMin_mV;
+  shared_ptr<float>          fMean_mV;
+  shared_ptr<float>          fStart_s;
+  shared_ptr<float>          fBase_mV;
+  shared_ptr<int64_t>        fRaw_entry;
+  shared_ptr<vector<short>>  fADC;
+
+  unique_ptr<RNT::RNTupleWriter> fWriter;
+};
+#endif
+
+class CookedReader {
+public:
+  virtual ~CookedReader(){}
+
+  virtual long long GetEntries() = 0;
+  // scalars only
+  virtual int       GetEntry(long long entry) = 0;
+  // waveform into *ADC, 0 if no ADC
+  // branch (or field)
+  virtual int       LoadADC(long long entry) = 0;
+
+  // nullptr if the object is missing
+  static CookedReader * Open(TDirectory * dir,
+			     string name,
+			     CookedVars vars);
+  
+  // several files of one run (cook_raw -o),
+  // TTree only, read as a TChain
+  static CookedReader * Open(vector<string> fileNames,
+			     string name,
+			     CookedVars vars);
+};
+
+class CookedTreeReader : public CookedReader {
+public:
+  CookedTreeReader(TTree * tree,
+		   CookedVars vars);
+
+  long long GetEntries();
+  int       GetEntry(long long entry);
+  int       LoadADC(long long entry);
+
+  TTree   * GetTree();
+  char      GetLayout();
+
+private:
+  TTree         * fTree;
+  // disabled for GetEntry
+  TBranch       * fB_ADC = nullptr;
+  vector<short>   fADC_arr;
+  char            fLayout;
+};
+
+#ifdef WITH_RNTUPLE
+class CookedNTupleReader : public CookedReader {
+public:
+  CookedNTupleReader(TDirectory * dir,
+		     string name,
+		     CookedVars vars);
+
+  long long GetEntries();
+  int       GetEntry(long long entry);
+  int       LoadADC(long long entry);
+
+private:
+  using FloatView = decltype(declval<RNT::RNTupleReader&>().GetView<float>(""));
+  using ShortView = decltype(declval<RNT::RNTupleReader&>().GetView<short>(""));
+  using LongView  = decltype(declval<RNT::RNTupleReader&>().GetView<int64_t>(""));
+  using ADCView   = decltype(declval<RNT::RNTupleReader&>().GetView<vector<short>>(""));
+
+  CookedVars    fVars;
+  vector<short> fADC_buff;
+
+  unique_ptr<RNT::RNTupleReader> fReader;
+
+  unique_ptr<FloatView> fPeak_mV;
+  unique_ptr<ShortView> fPeak_samp;
+  unique_ptr<FloatView> fMin_mV;
+  unique_ptr<FloatView> fMean_mV;
+  unique_ptr<FloatView> fStart_s;
+  unique_ptr<FloatView> fBase_mV;
+  unique_ptr<LongView>  fRaw_entry;
+  unique_ptr<ADCView>   fADC;
+};
+#endif
+
+#endif
@@ -0,0 +1,73 @@
+/*----------
+  PURPOSE
+  2D voltage histograms booked over a window
+  of interest rather than the full ADC range
+
+  At ADC resolution the full range is about
+  16k x 16k bins (1 GB per TH2F) whereas the
+  plots show a few tens of mV. Bins keep the
+  full range grid (centres at gridMin +
+  n*binWidth, as Set_THF_Params) so zoomed
+  plots are unchanged. Entries outside the
+  window are kept in the under/overflow bins
+  of each axis.
+
+  USAGE
+  #include "HistWindow.h"
+
+  HistWindow minWin  = { -50., 50.};
+  HistWindow peakWin = { -50.,150.};
+
+  TH2F * h = NewWindowTH2F("h","h;min;peak",
+                           -range/2.,binWidth,
+                           minWin,peakWin);
+*/
+
+#ifndef HistWindow_h
+#define HistWindow_h
+
+#include <TH2.h>
+
+#include <math.h>
+
+// mV
+struct HistWindow {
+  float low;
+  float high;
+};
+
+// edges and number of grid bins
+// covering the window
+inline void SetWindowParams(float gridMin,
+			    float binWidth,
+			    HistWindow window,
+			    float * minX,
+			    float * maxX,
+			    int   * nBins){
+
+  int first = (int)floorf((window.low  - gridMin)/binWidth);
+  int last  = (int)ceilf ((window.high - gridMin)/binWidth);
+
+  *nBins = last - first + 1;
+  *minX  = gridMin + (first - 0.5)*binWidth;
+  *maxX  = gridMin + (last  + 0.5)*binWidth;
+}
+
+inline TH2F * NewWindowTH2F(const char * name,
+			    const char * title,
+			    float gridMin,
+			    float binWidth,
+			    HistWindow xWindow,
+			    HistWindow yWindow){
+  float minX, maxX, minY, maxY;
+  int   nBinsX, nBinsY;
+
+  SetWindowParams(gridMin,binWidth,xWindow,&minX,&maxX,&nBinsX);
+  SetWindowParams(gridMin,binWidth,yWindow,&minY,&maxY,&nBinsY);
+
+  return new TH2F(name,title,
+		  nBinsX,minX,maxX,
+		  nBinsY,minY,maxY);
+}
+
+#endif
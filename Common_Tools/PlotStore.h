@@ -0,0 +1,175 @@
+/*----------
+  PURPOSE
+  Monitoring plots either drawn straight
+  away as PDFs or, for batch jobs, kept as
+  histograms in one summary file per run,
+  with no canvas created, for render_plots
+  (../Plotting) to draw later
+
+  'P' PDFs (default)
+  'H' histograms only
+
+  A plot is a histogram with its axis ranges,
+  draw option (SetOption) and any overlays
+  (e.g. TLine added to GetListOfFunctions())
+  set, drawn on a pad with options
+    "logy" "logz" "grid" "<w>x<h>"
+  (window size, 1000x800 by default)
+
+  The summary file holds the histograms and
+  'plots', a TObjArray of TNamed with name
+  the PDF path (relative to the summary
+  file's folder) and title the histogram
+  name and pad options. 'style' is the
+  TStyle the plots were made with.
+
+  USAGE
+  #include "PlotStore.h"
+
+  PlotStore * plots = new PlotStore('H',"./Plots/run_plots.root");
+
+  hist->SetOption("colz");
+  plots->Add(hist,"./Plots/Dark/hist.pdf","logz grid");
+
+  // summary written
+  delete plots;
+*/
+
+#ifndef PlotStore_h
+#define PlotStore_h
+
+#include <TH1.h>
+#include <TCanvas.h>
+#include <TFile.h>
+#include <TNamed.h>
+#include <TObjArray.h>
+#include <TDirectory.h>
+#include <TStyle.h>
+#include <TROOT.h>
+
+#include <string>
+#include <sstream>
+
+using namespace std;
+
+inline void DrawPlot(TCanvas * canvas,
+		     TH1 * hist,
+		     string pdfPath,
+		     string padOptions){
+
+  bool  logy = false, logz = false, grid = false;
+  float w = 1000., h = 800.;
+
+  istringstream options(padOptions);
+
+  for( string option ; options >> option ; ){
+    if     ( option == "logy" ) logy = true;
+    else if( option == "logz" ) logz = true;
+    else if( option == "grid" ) grid = true;
+    else sscanf(option.c_str(),"%fx%f",&w,&h);
+  }
+
+  canvas->SetWindowSize(w,h);
+  canvas->cd();
+
+  canvas->SetLogy(logy);
+  canvas->SetLogz(logz);
+  canvas->SetGrid(grid,grid);
+
+  hist->Draw(hist->GetOption());
+
+  canvas->SaveAs(pdfPath.c_str());
+}
+
+class PlotStore {
+ public:
+  PlotStore(char output,
+	    string summaryPath) :
+    fOutput(output),
+    fSummaryPath(summaryPath){
+
+    fPlots.SetOwner(true);
+
+    // relative PDF paths start here
+    size_t slash = summaryPath.rfind('/');
+    if( slash != string::npos )
+      fFolder = summaryPath.substr(0,slash + 1);
+  }
+
+  // summary written, canvas deleted
+  ~PlotStore(){
+
+    delete fCanvas;
+
+    if( !fFile )
+      return;
+
+    TDirectory::TContext context(fFile);
+
+    TNamed style("style",gStyle->GetName());
+    style.Write();
+
+    fPlots.Write("plots",TObject::kSingleKey);
+
+    printf("\n Plots saved to %s (render_plots) \n",
+	   fSummaryPath.c_str());
+
+    fFile->Close();
+    delete fFile;
+  }
+
+  char GetOutput(){ return fOutput; }
+
+  // 'P' drawn now, 'H' histogram written
+  void Add(TH1 * hist,
+	   string pdfPath,
+	   string padOptions = ""){
+
+    if( fOutput != 'H' ){
+      if( !fCanvas )
+	fCanvas = new TCanvas();
+
+      DrawPlot(fCanvas,hist,pdfPath,padOptions);
+      return;
+    }
+
+    // opening a file changes gDirectory
+    TDirectory::TContext context;
+
+    if( !fFile ){
+      fFile = new TFile(fSummaryPath.c_str(),"RECREATE");
+
+      if( fFile->IsZombie() ){
+	fprintf( stderr, "\n Error: cannot write %s \n ",fSummaryPath.c_str());
+	delete fFile;
+	fFile   = nullptr;
+	fOutput = 'P';
+	// drawn instead
+	Add(hist,pdfPath,padOptions);
+	return;
+      }
+    }
+
+    if( !fFolder.empty() && pdfPath.compare(0,fFolder.size(),fFolder) == 0 )
+      pdfPath = pdfPath.substr(fFolder.size());
+
+    fFile->cd();
+    hist->Write(hist->GetName(),TObject::kOverwrite);
+
+    string title = string(hist->GetName()) + " " + padOptions;
+
+    fPlots.Add(new TNamed(pdfPath.c_str(),title.c_str()));
+  }
+
+ private:
+  // 'P' once the summary file fails
+  char      fOutput;
+  string    fSummaryPath;
+  string    fFolder;
+
+  TCanvas * fCanvas = nullptr;
+  TFile   * fFile   = nullptr;
+  TObjArray fPlots;
+};
+
+#endif
@@ -0,0 +1,72 @@
+/*----------
+  PURPOSE
+  Numeric command line option values, range
+  checked. stoi and friends throw on a value
+  that is not a number (aborting the program)
+  and accept trailing junk ('-o 5GB' as 5).
+
+  USAGE
+  #include "ReadNumber.h"
+
+  long long value = 0;
+
+  if( !ReadNumber("-j",argv[i],0,INT_MAX,&value) ){
+    PrintUsage();
+    return -1;
+  }
+
+  The error is printed, the caller decides
+  what to do next.
+ ----------*/
+
+#ifndef ReadNumber_h
+#define ReadNumber_h
+
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <cfloat>
+#include <string>
+
+// whole number from min to max,
+// false and an error otherwise
+inline bool ReadNumber(std::string option, const char * arg,
+		       long long min, long long max, long long * value){
+
+  char * end = nullptr;
+
+  errno  = 0;
+  *value = strtoll(arg,&end,10);
+
+  if( end == arg || *end != 0 || errno == ERANGE ||
+      *value < min || *value > max ){
+    fprintf( stderr, "\n Error: %s needs a whole number from %lld to %lld, not '%s' \n ",
+	     option.c_str(),min,max,arg);
+    return false;
+  }
+
+  return true;
+}
+
+// any number from min to max (no nan
+// or inf), false and an error otherwise
+inline bool ReadReal(std::string option, const char * arg,
+		     double min, double max, double * value){
+
+  char * end = nullptr;
+
+  errno  = 0;
+  *value = strtod(arg,&end);
+
+  if( end == arg || *end != 0 || errno == ERANGE ||
+      !( *value >= min && *value <= max ) ){
+    fprintf( stderr, "\n Error: %s needs a number from %g to %g, not '%s' \n ",
+	     option.c_str(),min,max,arg);
+    return false;
+  }
+
+  return true;
+}
+
+#endif
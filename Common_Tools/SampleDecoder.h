@@ -0,0 +1,115 @@
+/*----------
+  PURPOSE
+  Decoding wavedump sample words into the
+  16 bit ADC values stored in the 'ADC' branch
+
+  'V' VME digitiser
+      16 bit samples, copied as they are
+  'D' desktop (x742) digitiser
+      32 bit float samples, rounded to the
+      nearest (even) integer and clamped to
+      SHRT_MIN - SHRT_MAX. NaN, and values
+      outside the 32 bit integer range (either
+      sign, e.g. >= 2^31), become SHRT_MIN.
+      (SSE2 eight samples per iteration, as two
+       groups of four, scalar for the rest and
+       without SSE2 - both give the same result)
+
+  The digitiser is a template parameter so a
+  reader picks the specialised decoder once
+  per file rather than testing per sample.
+
+  USAGE
+  #include "SampleDecoder.h"
+
+  DecodeSamples<DesktopDigitiser>(in,ADC.data(),nSamples);
+
+*/
+
+#ifndef SampleDecoder_h
+#define SampleDecoder_h
+
+#include <cstring>
+#include <cmath>
+#include <climits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+struct VMEDigitiser {
+  typedef short Word;
+  static const char kID = 'V';
+};
+
+struct DesktopDigitiser {
+  typedef float Word;
+  static const char kID = 'D';
+};
+
+// bytes per sample word
+inline unsigned int GetSampleBytes(char digitiser){
+
+  if( digitiser == DesktopDigitiser::kID )
+    return sizeof(DesktopDigitiser::Word);
+
+  return sizeof(VMEDigitiser::Word);
+}
+
+// 'in' holds nSamples words,
+// not necessarily aligned
+template <class Digitiser>
+void DecodeSamples(const char * in,
+		   short * out,
+		   unsigned int nSamples);
+
+template <>
+inline void DecodeSamples<VMEDigitiser>(const char * in,
+					short * out,
+					unsigned int nSamples){
+  memcpy(out,in,(size_t)nSamples*sizeof(short));
+}
+
+template <>
+inline void DecodeSamples<DesktopDigitiser>(const char * in,
+					    short * out,
+					    unsigned int nSamples){
+  unsigned int i = 0;
+
+#if defined(__SSE2__)
+  // cvtps rounds to nearest (even),
+  // packs saturates to 16 bits
+  for( ; i + 8 <= nSamples ; i += 8 ){
+    __m128 lo = _mm_loadu_ps((const float*)(in) + i);
+    __m128 hi = _mm_loadu_ps((const float*)(in) + i + 4);
+
+    __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(lo),
+				     _mm_cvtps_epi32(hi));
+
+    _mm_storeu_si128((__m128i*)(out + i),packed);
+  }
+#endif
+
+  for( ; i < nSamples ; i++ ){
+    float sample;
+    memcpy(&sample,in + (size_t)i*sizeof(float),sizeof(float));
+
+    // as the SSE2 path: NaN or beyond 
+    // 32 bit range gives SHRT_MIN
+    if( !(sample >= -2147483648.f && sample < 2147483648.f) ){
+      out[i] = SHRT_MIN;
+      continue;
+    }
+
+    long value = lrintf(sample);
+
+    if( value > SHRT_MAX )
+      value = SHRT_MAX;
+    else if( value < SHRT_MIN )
+      value = SHRT_MIN;
+
+    out[i] = (short)value;
+  }
+}
+
+#endif
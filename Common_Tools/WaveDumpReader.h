@@ -0,0 +1,255 @@
+/***************************************************
+ * A class for reading CAEN wavedump binary files
+ *
+ * Purpose
+ *  Bulk reader for the events in a wavedump
+ *  .dat file. The file is memory mapped and
+ *  each event is sliced out of the mapping
+ *  using the event size in HEAD[0].
+ *  If the file cannot be mapped (or the user
+ *  requests it) events are instead read with
+ *  one stream read per header and per waveform
+ *  through a large stream buffer.
+ *
+ * Event format (VME)
+ *  unsigned int HEAD[6]  6 * 32 bits = 24 bytes
+ *  short        ADC[N]   N * 16 bits (N = No. samples)
+ *
+ * Event format (desktop, x742)
+ *  unsigned int HEAD[6]  
+ *  float        ADC[N]   N * 32 bits 
+ *
+ *  Samples of either are decoded to shorts by
+ *  the SampleDecoder.h specialisation chosen 
+ *  when the file is opened.
+ *
+ *  HEAD[0] event size in bytes (header plus samples)
+ *  HEAD[1] board ID
+ *  HEAD[2] pattern (VME)
+ *  HEAD[3] channel
+ *  HEAD[4] event counter
+ *  HEAD[5] trigger time tag
+ *
+ * Event index
+ *  The byte offset, event counter and trigger
+ *  time tag of every event can be found with 
+ *  one header-only scan and kept in a sidecar
+ *  file (<file>.idx) so that later random
+ *  access (GetEvent, GetEvents) needs no scan.
+ *  A sidecar for a file that has since grown
+ *  is extended from its last event.
+ *
+ * Growing files
+ *  A file that wavedump is still writing can
+ *  be followed: NextEvent() leaves the reader 
+ *  at the start of an incomplete final event
+ *  and Refresh() picks up the new file size,
+ *  after which the event can be read.
+ *
+ */
+
+#ifndef WaveDumpReader_h
+#define WaveDumpReader_h
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "SampleDecoder.h"
+
+using namespace std;
+
+class WaveDumpReader {
+public:
+
+  WaveDumpReader();
+  // open file on construction
+  // digitiser 'V' VME, 'D' desktop
+  WaveDumpReader(string path,
+		 bool useMMap = true,
+		 char digitiser = 'V');
+  ~WaveDumpReader();
+
+  bool   Open(string path,
+	      bool useMMap = true,
+	      char digitiser = 'V');
+  void   Close();
+
+  bool   IsOpen();
+  bool   IsMapped();
+
+  // copy next event into HEAD and ADC,
+  // returns false at the end of the file
+  // or if the last event is incomplete
+  bool   NextEvent(unsigned int * HEAD,
+		   vector<short> * ADC);
+
+  // return to first event
+  void   Rewind();
+  
+  // true if the whole of the next 
+  // event is in the file
+  bool   IsEventComplete();
+  
+  // re-check the file size (and remap),
+  // returns true if the file has grown
+  bool   Refresh();
+
+  // position the reader at event 'entry'
+  // (assumes every event is the size of the first)
+  bool   SeekEvent(long long entry);
+
+  // number of complete events in the file
+  // (indexed, or assuming every event is 
+  //  the size of the first)
+  long long GetNEvents();
+  
+  //--------------------
+  // event index
+  
+  // read <file>.idx if it matches the file,
+  // otherwise (or if the file has grown)
+  // scan the headers and rewrite it
+  bool   LoadIndex();
+  
+  // header-only scan, continuing from the 
+  // last indexed event if there is one
+  bool   BuildIndex();
+  
+  bool   ReadIndex(string path = "");
+  bool   WriteIndex(string path = "");
+  
+  bool   HasIndex();
+  string GetIndexPath();
+  
+  // indexed, or assuming fixed event size
+  long long    GetEventOffset(long long entry);
+  // index only (0 if not indexed)
+  unsigned int GetEventCounter(long long entry);
+  unsigned int GetTimeTag(long long entry);
+  
+  //--------------------
+  // random access
+  
+  // copy event 'entry' into HEAD and ADC
+  bool   GetEvent(long long entry,
+		  unsigned int * HEAD,
+		  vector<short> * ADC);
+  
+  // copy the header of event 'entry' only,
+  // the read position is unchanged
+  bool   GetHeader(long long entry,
+		   unsigned int * HEAD);
+  
+  // copy up to nEvents events starting at
+  // 'first', 6 HEAD words and HEAD[0] 
+  // sized waveform per event appended to 
+  // the (cleared) vectors,
+  // returns the number of events copied
+  long long GetEvents(long long first,
+		      long long nEvents,
+		      vector<unsigned int> * HEAD,
+		      vector<short> * ADC);
+
+  // from first header in file
+  unsigned int GetEventSize();
+  unsigned int GetNSamples();
+
+  long long GetFileSize();
+  long long GetBytesRead();
+
+  string GetPath();
+  
+  char   GetDigitiser();
+
+private:
+
+  void   Init();
+
+  bool   MapFile();
+  bool   OpenStream();
+
+  // move to a byte offset (either reader)
+  void   SeekOffset(long long offset);
+
+  bool   ReadHeader(unsigned int * HEAD);
+  bool   ReadSamples(short * ADC,
+		     unsigned int nSamples);
+  
+  // specialised per digitiser,
+  // selected by Open()
+  template <class Digitiser>
+  bool   ReadSamplesT(short * ADC,
+		      unsigned int nSamples);
+  
+  bool   (WaveDumpReader::*fReadSamples)(short *,
+					 unsigned int);
+
+  string        fPath;
+
+  // mapped file
+  int           fFD;
+  char        * fMap;
+
+  // fallback
+  ifstream      fStream;
+  vector<char>  fStreamBuf;
+  // undecoded samples (stream reads)
+  vector<char>  fWordBuf;
+  
+  char          fDigitiser;
+  unsigned int  fSampleBytes;
+
+  long long     fFileSize;
+  long long     fOffset;
+
+  unsigned int  fEventSize;
+  unsigned int  fNSamples;
+  
+  // event index
+  vector<long long>     fIdxOffset;
+  vector<unsigned int>  fIdxCounter;
+  vector<unsigned int>  fIdxTimeTag;
+
+};
+
+#endif
+
+#ifdef WaveDumpReader_cxx
+
+WaveDumpReader::WaveDumpReader(){
+  Init();
+}
+
+WaveDumpReader::WaveDumpReader(string path,
+			       bool useMMap,
+			       char digitiser){
+  Init();
+  Open(path,useMMap,digitiser);
+}
+
+WaveDumpReader::~WaveDumpReader(){
+  Close();
+}
+
+void WaveDumpReader::Init(){
+
+  fPath      = "";
+  fFD        = -1;
+  fMap       = nullptr;
+  fFileSize  = 0;
+  fOffset    = 0;
+  fEventSize = 0;
+  fNSamples  = 0;
+  
+  fDigitiser   = 'V';
+  fSampleBytes = 2;
+  fReadSamples = &WaveDumpReader::ReadSamplesT<VMEDigitiser>;
+  
+  fIdxOffset.clear();
+  fIdxCounter.clear();
+  fIdxTimeTag.clear();
+
+}
+
+#endif
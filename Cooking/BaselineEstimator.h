@@ -0,0 +1,108 @@
+/***************************************************
+ * Per-event baseline estimators
+ *
+ * Purpose
+ *  The baseline of one waveform, as a mean ADC
+ *  count, for the cooking kernel.
+ *
+ *   'F' fixed window - mean of the leading
+ *       samples (first 50 ns, default)
+ *   'M' mode - most populous count of the
+ *       unmasked samples (centroid of the mode
+ *       and its neighbours) from a small
+ *       histogram around the quieter of the
+ *       leading and trailing windows
+ *   'T' truncated mean - mean of the middle
+ *       half (interquartile) of the unmasked
+ *       samples, from the same histogram
+ *   'P' pre/post pulse window - leading or
+ *       trailing window, whichever has the
+ *       smaller spread (both if equal)
+ *
+ *  Init() sets the sample ranges once per file,
+ *  Estimate() is then const so one estimator
+ *  can be shared by all cooking threads.
+ *
+ *  No ROOT dependence (see cook_bench).
+ *
+ */
+
+#ifndef BaselineEstimator_h
+#define BaselineEstimator_h
+
+#include "CookKernel.h"
+
+class BaselineEstimator {
+public:
+  virtual ~BaselineEstimator(){}
+
+  // sample ranges from the constants
+  virtual void   Init(const CookConstants & constants);
+
+  // mean ADC count of the baseline
+  virtual double Estimate(const short * ADC) const = 0;
+
+  virtual char   GetID() const = 0;
+
+  // nullptr if the id is unknown
+  static BaselineEstimator * Create(char id);
+
+protected:
+
+  // leading window
+  int fNBaseSamps = 0;
+  // samples before the mask
+  int fNUnmasked  = 0;
+  // trailing window, as long as the
+  // leading one, ending at the mask
+  int fNPostSamps = 0;
+  int fPostFirst  = 0;
+
+  double WindowMean(const short * ADC,
+		    int first,
+		    int n,
+		    int * spread) const;
+
+  // mean of the window with less spread
+  double PrePostMean(const short * ADC) const;
+};
+
+class FixedWindowBaseline : public BaselineEstimator {
+public:
+  double Estimate(const short * ADC) const;
+  char   GetID() const { return 'F'; }
+};
+
+// counts within kHalfWidth of PrePostMean,
+// outliers counted below/above
+class HistogramBaseline : public BaselineEstimator {
+public:
+  static const int kHalfWidth = 128;
+  static const int kNBins     = 2*kHalfWidth;
+
+protected:
+  // returns the histogram offset (count of bin 0)
+  int Fill(const short * ADC,
+	   unsigned short * hist,
+	   int * nBelow) const;
+};
+
+class ModeBaseline : public HistogramBaseline {
+public:
+  double Estimate(const short * ADC) const;
+  char   GetID() const { return 'M'; }
+};
+
+class TruncatedMeanBaseline : public HistogramBaseline {
+public:
+  double Estimate(const short * ADC) const;
+  char   GetID() const { return 'T'; }
+};
+
+class PrePostBaseline : public BaselineEstimator {
+public:
+  double Estimate(const short * ADC) const;
+  char   GetID() const { return 'P'; }
+};
+
+#endif
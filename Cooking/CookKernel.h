@@ -0,0 +1,170 @@
+/***************************************************
+ * Per-event cooking kernel
+ *
+ * Purpose
+ *  Baseline, min, peak, peak sample and mean of
+ *  one waveform plus the flipped (and masked)
+ *  ADC output, from contiguous int16 samples.
+ *
+ *  One pass over the samples after the leading
+ *  baseline window, with
+ *   'V' AVX2, eight samples at a time
+ *   'S' scalar
+ *   'A' AVX2 if the CPU has it (default)
+ *   'R' reference - the original two pass loop
+ *   'I' integer - ADC counts only (AVX2 sixteen
+ *       samples at a time if available)
+ *
+ *  For 'V' and 'S' base_mV, min_mV, peak_mV,
+ *  peak_samp and the ADC output are bit-exact
+ *  with the reference. mean_mV is summed in
+ *  eight interleaved partial sums (the same in
+ *  'V' and 'S') so differs from the sequential
+ *  sum by rounding only (< 1E-3 mV for
+ *  cook_bench waveforms).
+ *
+ *  'I' uses that ADC_To_Wave is linear: the
+ *  baseline sum, min, max and sum of the ADC
+ *  counts are integers and only these are
+ *  converted to mV, once per event. The mV
+ *  values then differ from the reference by
+ *  float rounding only (the reference rounds
+ *  every sample).
+ *
+ *  The baseline is the mean of the leading
+ *  window unless another estimator is set
+ *  (see BaselineEstimator.h); all modes use
+ *  the same estimator so the comparisons
+ *  above hold for each.
+ *
+ *  No ROOT dependence so that cook_bench can
+ *  time and compare the modes standalone.
+ *
+ */
+
+#ifndef CookKernel_h
+#define CookKernel_h
+
+#include <vector>
+#include <memory>
+
+using namespace std;
+
+class BaselineEstimator;
+
+// digitiser and user settings
+// (see TCooker::SetConstants)
+struct CookConstants {
+  short nSamples     = 0;
+  // leading samples averaged for baseline
+  short nBaseSamps   = 0;
+  // -1 means no mask
+  short firstMaskBin = -1;
+  short nADCBins     = 16384;
+  char  pulsePol     = 'N';
+  float mVPerBin     = 0.;
+  float range_mV     = 0.;
+  float ampGain      = 10.;
+};
+
+struct CookedValues {
+  float base_mV   = 0.;
+  float min_mV    = 0.;
+  float peak_mV   = 0.;
+  float mean_mV   = 0.;
+  short peak_samp = 0;
+};
+
+class CookKernel {
+public:
+
+  CookKernel();
+
+  // 'A', 'V', 'S', 'R' or 'I', see above
+  // returns false if unavailable
+  bool  SetMode(char mode);
+  char  GetMode();
+
+  void  SetConstants(CookConstants constants);
+
+  // 'F' fixed window (default), 'M' mode,
+  // 'T' truncated mean, 'P' pre/post window
+  // returns false if unknown
+  bool  SetBaseline(char id);
+  char  GetBaseline();
+
+  // ADC holds, ADC_out receives nSamples
+  void  Cook(const short * ADC,
+	     short * ADC_out,
+	     CookedValues * values);
+
+  // as TCooker
+  float ADC_To_Wave(short ADC);
+  short Wave_To_ADC(float wave);
+  short Invert_Negative_ADC_Pulses(short ADC);
+
+  static bool HasAVX2();
+
+private:
+
+  float Baseline(const short * ADC);
+
+  void  CookReference(const short * ADC,
+		      short * ADC_out,
+		      CookedValues * values);
+  void  CookScalar(const short * ADC,
+		   short * ADC_out,
+		   CookedValues * values);
+  void  CookAVX2(const short * ADC,
+		 short * ADC_out,
+		 CookedValues * values);
+  void  CookInteger(const short * ADC,
+		    short * ADC_out,
+		    CookedValues * values);
+
+  // ADC count to mV, relative to the
+  // baseline (mean count)
+  double Counts_To_mV(double ADC,
+		      double baseCount);
+
+  // ADC_To_Wave of a mean count
+  double Count_To_Wave(double count);
+
+  // SIMD arithmetic reproduces ADC_To_Wave
+  // for every short (or 'V' is refused)
+  bool  CheckAVX2();
+
+  CookConstants fConst;
+
+  char          fMode;
+  char          fRequestMode;
+  bool          fAVX2Exact;
+
+  // ADC_To_Wave for all 65536 shorts
+  vector<float> fWave;
+
+  // d(ADC_To_Wave)/d(ADC)
+  double        fmVPerCount;
+
+  // shared by copies (one per cooking
+  // thread), Estimate() is const
+  shared_ptr<BaselineEstimator> fBaseline;
+
+};
+
+#endif
+
+#ifdef CookKernel_cxx
+
+CookKernel::CookKernel(){
+
+  fMode        = 'S';
+  fRequestMode = 'A';
+  fAVX2Exact   = false;
+
+  SetBaseline('F');
+  SetConstants(CookConstants());
+
+}
+
+#endif
@@ -4,6 +4,7 @@
 #include <TROOT.h>
 #include <TTree.h>
 #include <TFile.h>
+#include <TChain.h>
 #include <TH2.h>
 #include <TCanvas.h>
 #include <TStyle.h>
@@ -13,53 +14,123 @@
 #include <vector>
 #include <limits.h>
 
+#include "WaveDumpReader.h"
+#include "DataStore.h"
+#include "CookKernel.h"
+#include "HistWindow.h"
+
 using namespace std;
 
+// per event hook into the cooking loop, 
+// called in entry order with HEAD, start_s
+// and (if cooked) the cooked variables set
+// so that monitoring shares the raw data
+// read rather than looping over it again
+class CookObserver {
+ public:
+  virtual ~CookObserver(){}
+  
+  virtual void Begin(){}
+  virtual void Event(Long64_t entry,
+		     bool cooked) = 0;
+  virtual void End(){}
+};
+
+// one cooked event as written
+struct CookedEvent {
+  CookedValues values;
+  float        start_s   = 0.;
+  Long64_t     raw_entry = 0;
+};
+
+// fills cooked output on its own thread
+// (TCooker.C)
+class WriteBehind;
+
+// monitoring plots, PDFs or a 
+// summary file (PlotStore.h)
+class PlotStore;
+
 class TCooker {
  public :
   
   //--------------------
   // Input 
+  // TTree or a TChain of a run's files
   TTree *rawTree;
   int   treeNumber;
 
   // raw root data tree variables
   uint HEAD[6];
   vector<short> * ADC = 0;     // reading
+  vector<short>   ADC_arr;     // reading (array layout)
   vector<short>   ADC_buff;    // writing
+  vector<short> * ADC_out = 0; // bound to cooked writer
   
   TBranch * b_HEAD = 0;  
   TBranch * b_ADC  = 0;   
   
+  // wavedump binary input
+  // (replaces raw tree)
+  WaveDumpReader * datReader = nullptr;
+  vector<short>    ADC_dat;
+  
+  // raw RNTuple input 
+  // (replaces raw tree)
+  RawNTupleReader * ntReader = nullptr;
+  
   //--------------------
   // Output
   TFile * outFile;
   
+  // optional raw data tree 
+  // written from binary input
+  TFile     * rawOutFile = nullptr;
+  RawWriter * rawWriter  = nullptr;
+  
   // meta data tree for 
   // storing constants
   TTree * metaTree;
-  TTree * cookedTree;
   
-  // dont save - ADC is smaller
-  vector <float>  wave_mV;
+  // TTree or RNTuple
+  CookedWriter * cookedWriter = nullptr;
+  
+  // per event cooking
+  CookKernel kernel;
 
-  // variables for writing
+  // variables of the entry being cooked
+  // (observers), written from a copy
   float base_mV; // baseline (average in mV) 
   float min_mV;
   float peak_mV;
   float mean_mV;
   short peak_samp;
   float start_s; // event start time
+  // entry of the raw tree 'T' (Meta_Data 
+  // RawFile) the event was cooked from
+  Long64_t raw_entry;
 
   TCooker(TTree *tree=0,
 	  char digitiser='V', // Program default is VME 1730
 	  char sampSet='2',   // variable only used for digitiser='D'
 	  char pulsePol='N'); // 'N' Neg or 'P' Pos
+  // cook directly from wavedump binary
+  TCooker(WaveDumpReader * reader,
+	  char digitiser='V',
+	  char sampSet='2',
+	  char pulsePol='N');
+  // cook from raw RNTuple (WITH_RNTUPLE)
+  TCooker(RawNTupleReader * reader,
+	  char digitiser='V',
+	  char sampSet='2',
+	  char pulsePol='N');
   virtual ~TCooker();
-  virtual int  GetEntry(int entry);
-  virtual int  LoadTree(int entry);
+  virtual int      GetEntry(Long64_t entry);
+  virtual Long64_t LoadTree(Long64_t entry);
   virtual bool Init(TTree *tree=0);
-  virtual void Show(int entry = -1);
+  virtual bool Init(WaveDumpReader * reader);
+  virtual bool Init(RawNTupleReader * reader);
+  virtual void Show(Long64_t entry = -1);
   
   void InitCanvas(float w = 1000.,
 		  float h = 800.);
@@ -85,11 +156,13 @@ class TCooker {
   void  PrintConstants();
   
   // limit entries for faster testing
-  void  SetTestMode(int);
+  void  SetTestMode(Long64_t);
   
   //--------------------------
   // Cooking 
-  void  Cook();
+  // false (no output saved) if cooking
+  // stopped before the last entry
+  bool  Cook();
   
   void  InitCooking();
   void  InitCookedDataFile(string option = "RECREATE");
@@ -101,11 +174,22 @@ class TCooker {
   void  InitCookedData();
   void  CloseCookedData();
   
-  void  DoCooking();
+  bool  DoCooking();
   
   void  SaveMetaData();
   void  SaveCookedData();
   
+  // output file (part) name
+  string GetCookedFileName(int part);
+  // delete the output of incomplete cooking
+  void  DiscardOutput();
+  
+  // binary input only: also write
+  // raw tree 'T' to <file>.dat.root
+  void  SetRawOutput(bool writeRaw);
+  void  InitRawDataFile();
+  void  SaveRawData();
+  
   float ADC_To_Wave(short ADC);
   float Wave_To_Amp_Scaled_Wave(float wave);
 
@@ -118,18 +202,39 @@ class TCooker {
   short GetNSamples();
   short GetNADCBins();
 
+  // observers are not owned
+  void  AddObserver(CookObserver * observer);
+  
   //---   
   // Monitor DAQ
-  void  DAQ();
+  // separate pass over the headers,
+  // false (no plots) if one is not read
+  bool  DAQ();
+  // or filled while cooking
+  void  MonitorDAQ();
   
   void  InitDAQ();
+  void  FillDAQ(Long64_t entry);
+  void  EndDAQ();
   void  SaveDAQ(string outFolder = "./Plots/DAQ/");
   
   double GetTrigTimeTag();
-  double GetTrigTimeTag(int entry);
+  double GetTrigTimeTag(Long64_t entry);
+  
+  // header only read into HEAD, no ADC:
+  // HEAD branch of a tree, HEAD field of
+  // an RNTuple, or for binary input the
+  // .idx sidecar (dat_to_root -i Y, which
+  // sets HEAD[4] and HEAD[5] only) else 
+  // the 24 byte header
+  bool   ReadHead(Long64_t entry);
   
   double GetElapsedTime(int * cycles,
 			double prevTime);
+  // from the header of this entry
+  double GetElapsedTime(Long64_t entry,
+			int * cycles,
+			double prevTime);
   
   void  CountMissedEvents(int dTrigEntry);
 
@@ -146,6 +251,85 @@ class TCooker {
   
   void  SetAmpGain(float amp_gain);
   void  SetFirstMaskBin(short first_mask_bin);
+  
+  // output ADC branch layout
+  // 'V' vector (default), 'A' fixed length array
+  void  SetADCLayout(char layout);
+  
+  // output backend
+  // 'T' TTree (default), 'N' RNTuple
+  void  SetBackend(char backend);
+  
+  // cooking kernel 
+  // 'A' best available (default), 'V' AVX2, 
+  // 'S' scalar, 'R' reference, 
+  // 'I' integer ADC counts (see CookKernel.h)
+  void  SetKernel(char mode);
+  
+  // baseline estimator
+  // 'F' first 50 ns (default), 'M' mode,
+  // 'T' truncated mean, 'P' quieter of the
+  // pre and post pulse windows 
+  // (see BaselineEstimator.h)
+  void  SetBaseline(char estimator);
+  
+  // cooking threads, each cooking its own
+  // entry ranges (1 sequential (default), 
+  // 0 all cores), output is in entry order
+  void  SetNThreads(int nThreads);
+  
+  // sequential cooking and DAQ(): raw entry
+  // ranges (about 4 MB each) read and 
+  // decompressed on a separate thread up to
+  // this many ahead (0, the default, reads
+  // in the loop). Not used for a memory
+  // mapped .dat file, which it would copy
+  void  SetReadAhead(int nRanges);
+  
+  // TTreeCache per raw tree reader, set for
+  // HEAD and ADC (HEAD alone for DAQ())
+  void  SetReadCache(Long64_t cacheBytes);
+  
+  // once a cooked output file passes this
+  // size the run continues in <FileID>_1.root,
+  // <FileID>_2.root ... each with its own
+  // Meta_Data (0, default, no limit)
+  void  SetMaxFileSize(Long64_t maxBytes);
+  
+  // cooked output profile
+  // 'F' full - ADC of every event (default)
+  // 'P' preselected - ADC only for events with
+  //     peak_mV above threshold, empty otherwise
+  //     (vector layout)
+  // 'S' scalars only - no ADC branch
+  // The cooked tree links every event to 
+  // the raw tree (raw_entry and Meta_Data
+  // RawFile) so dark can read waveforms
+  // back from there on demand
+  void  SetOutputProfile(char profile, 
+			 float thresh_mV = 10.);
+  
+  // cooked output filled on a separate
+  // writer thread from two alternating
+  // blocks of events (about 4 MB each) so
+  // cooking only waits if both are full
+  // (default off: the writer thread also 
+  // rolls over -o parts, closing and opening
+  // files while the cooking thread fills the
+  // raw output and DAQ histograms, not yet
+  // checked against a run without it), 
+  // nCompress > 0 also compresses baskets 
+  // (RNTuple pages) on that many threads
+  void  SetWriteBehind(bool writeBehind,
+		       int  nCompress = 0);
+  
+  // monitoring plots (DAQ, baseline)
+  // 'P' PDFs, drawn as each study ends (default)
+  // 'H' histograms only, no canvas, saved to
+  //     ./Plots/<FileID>_cook_raw.root by 
+  //     SavePlots() for render_plots
+  void  SetPlotOutput(char output);
+  void  SavePlots();
 
  private:
   
@@ -166,6 +350,26 @@ class TCooker {
   
   float  fAmpGain;
   
+  bool   fWriteRaw;
+  char   fADCLayout;
+  char   fBackend;
+  int    fNThreads;
+  int    fReadAhead;
+  bool   fWriteBehind;
+  char   fPlotOutput;
+  
+  Long64_t fReadCacheBytes;
+  
+  Long64_t fMaxFileBytes;
+  int      fFilePart;
+  
+  char   fOutProfile;
+  float  fWaveThresh_mV;
+  
+  // raw .root file(s) holding the 
+  // waveforms, space separated
+  string fRawFiles;
+  
   // default or set using above
   short  fSampFreq;
 
@@ -188,14 +392,23 @@ class TCooker {
   // mean of peak time
   float  fDelay_ns; 
 
-  // only accommodating int size here
-  Long64_t nentries64_t; // dummy
-  int      nentries;
+  Long64_t nentries;
   
   // DAQ
   float  startTime;
   int    nMissedEvents;
   
+  // FillDAQ state carried between entries
+  double daqPrevTime;
+  int    daqTrigCycles;
+  int    daqPrevTrigEntry;
+  int    daqDeltaEvents;
+  double daqDeltaT;
+  Long64_t nRateEvents;
+  
+  vector<CookObserver*> observers;
+  CookObserver        * daqObserver = nullptr;
+  
   TH1F * hNEventsTime = nullptr;
   TH1F * hEventRate   = nullptr;
   TH1F * hTrigFreq    = nullptr;
@@ -214,11 +427,80 @@ class TCooker {
   
   TCanvas * canvas = nullptr;
   
+  PlotStore * plots = nullptr;
+  
+  PlotStore * GetPlots();
+  
   void  SetDigitiser(char);
   void  SetSampSet(char);
   void  SetPulsePol(char);
   
+  void  SetDefaults(char digitiser,
+		    char sampSet,
+		    char pulsePol);
   void  SetConstants();
+  void  InitKernel();
+  void  InitCommon();
+  
+  // false if a thread failed
+  bool  DoCookingParallel();
+  bool  DoCookingReadAhead();
+  
+  // cook, fill and notify one entry 
+  // (HEAD and start_s set)
+  void  CookEntry(Long64_t iEntry,
+		  const short * wave,
+		  int nWave,
+		  double * cookTime);
+  
+  // rawTree if ranges can follow its 
+  // clusters, nullptr otherwise
+  TTree * GetClusterTree();
+  
+  // binary input read from a memory
+  // mapping (no read-ahead)
+  bool  IsMappedInput();
+  
+  // close this output file and
+  // continue in the next part
+  void  CheckFileSize();
+  
+  // bound to the cooked writer
+  CookedEvent   fOut;
+  
+  WriteBehind * writeBehind = nullptr;
+  
+  // entries with too few samples, written
+  // as zero waveforms with peak_samp -1 so
+  // cooked entry i stays raw entry i
+  Long64_t      nShort = 0;
+  vector<short> ADC_zero;
+  
+  void  WriteShortEntry(Long64_t iEntry,
+			int nWave);
+  
+  void  InitWriteBehind();
+  // wait for the writer, print its times
+  void  EndWriteBehind();
+  
+  // fill the cooked writer, from the
+  // writer thread if writing behind
+  void  FillCooked(const CookedEvent & event,
+		   const short * ADC_cooked);
+  
+  // queued for the writer if writing
+  // behind, filled now otherwise
+  void  WriteCooked(const CookedEvent & event,
+		    const short * ADC_cooked);
+  
+  // keep or drop this event's waveform
+  // according to the output profile
+  void  SelectWaveform();
+  
+  // raw tree file(s) of this run,
+  // empty for binary input without
+  // raw output
+  string GetRawFiles();
   
   short SetSampleFreq();
   short SetNSamples();
@@ -246,14 +528,7 @@ TCooker::TCooker(TTree *tree,
 		   char pulsePol) : rawTree(0) 
 {
   
-  SetDigitiser(digitiser); 
-  SetSampSet(sampSet); // for desktop digitiser
-  SetPulsePol(pulsePol); 
-  
-  // initialise to default
-  // user to set cook_raw.C
-  SetAmpGain(10);
-  SetFirstMaskBin(-1);
+  SetDefaults(digitiser,sampSet,pulsePol);
 
   //SetFileID();
   
@@ -272,23 +547,94 @@ TCooker::TCooker(TTree *tree,
   
 }
 
+TCooker::TCooker(WaveDumpReader * reader,
+		 char digitiser,
+		 char sampSet,
+		 char pulsePol) : rawTree(0) 
+{
+  
+  SetDefaults(digitiser,sampSet,pulsePol);
+  
+  if(!Init(reader))
+    fprintf( stderr, "\n Warning: binary input not initialised \n");
+  
+}
+
+TCooker::TCooker(RawNTupleReader * reader,
+		 char digitiser,
+		 char sampSet,
+		 char pulsePol) : rawTree(0) 
+{
+  
+  SetDefaults(digitiser,sampSet,pulsePol);
+  
+  if(!Init(reader))
+    fprintf( stderr, "\n Warning: raw RNTuple not initialised \n");
+  
+}
+
+void TCooker::SetDefaults(char digitiser,
+			  char sampSet,
+			  char pulsePol)
+{
+  SetDigitiser(digitiser); 
+  SetSampSet(sampSet); // for desktop digitiser
+  SetPulsePol(pulsePol); 
+  
+  // initialise to default
+  // user to set cook_raw.C
+  SetAmpGain(10);
+  SetFirstMaskBin(-1);
+  SetRawOutput(false);
+  SetADCLayout('V');
+  SetBackend('T');
+  SetNThreads(1);
+  SetReadAhead(0);
+  SetReadCache(32000000);
+  SetMaxFileSize(0);
+  SetOutputProfile('F');
+  SetWriteBehind(false);
+  SetPlotOutput('P');
+  
+  fFilePart = 0;
+}
+
 TCooker::~TCooker()
 {
+   delete daqObserver;
+   SavePlots();
    if (!rawTree) return;
-   delete rawTree->GetCurrentFile();
+   // a chain owns its files
+   if (rawTree->InheritsFrom(TChain::Class()))
+     delete rawTree;
+   else
+     delete rawTree->GetCurrentFile();
 }
 
-int TCooker::GetEntry(int entry)
+int TCooker::GetEntry(Long64_t entry)
 {
 // Read contents of entry.
+   if (datReader){
+     if( !datReader->SeekEvent(entry) ||
+	 !datReader->NextEvent(HEAD,&ADC_dat) )
+       return 0;
+     return HEAD[0];
+   }
+#ifdef WITH_RNTUPLE
+   if (ntReader){
+     if( !ntReader->GetEntry(entry,HEAD,&ADC_dat) )
+       return 0;
+     return HEAD[0];
+   }
+#endif
    if (!rawTree) return 0;
    return rawTree->GetEntry(entry);
 }
-int TCooker::LoadTree(int entry)
+Long64_t TCooker::LoadTree(Long64_t entry)
 {
 // Set the environment to read one entry
    if (!rawTree) return -5;
-   int centry = rawTree->LoadTree(entry);
+   Long64_t centry = rawTree->LoadTree(entry);
    if (centry < 0) return centry;
    if (rawTree->GetTreeNumber() != treeNumber) {
       treeNumber = rawTree->GetTreeNumber();
@@ -296,11 +642,11 @@ int TCooker::LoadTree(int entry)
    return centry;
 }
 
-void TCooker::SetTestMode(int user_nentries = 1000000){
+void TCooker::SetTestMode(Long64_t user_nentries = 1000000){
 
   nentries = user_nentries;  
   printf("\n Warning: \n ");
-  printf("  nentries set to %d for testing \n",nentries);
+  printf("  nentries set to %lld for testing \n",nentries);
   
 }
 
@@ -309,7 +655,7 @@ bool TCooker::Init(TTree *tree)
   printf("\n ------------------------------ \n");
   printf("\n Initialising Data \n");
   
-  nentries64_t = 0;
+  nentries = 0;
 
   if (!tree){
     fprintf( stderr, "\n Warning: tree not loaded \n ");
@@ -320,37 +666,109 @@ bool TCooker::Init(TTree *tree)
     treeNumber = -1;
     rawTree->SetMakeClass(1);
     rawTree->SetBranchAddress("HEAD",HEAD, &b_HEAD);
-    rawTree->SetBranchAddress("ADC",&ADC, &b_ADC);
+    // vector or fixed length array
+    SetBranchAddress_ADC(rawTree,&ADC,&ADC_arr,&b_ADC);
 
-    nentries64_t = rawTree->GetEntriesFast();
-    
-    if( nentries64_t > INT_MAX ){
-      fprintf(stderr,
-	      "\n Error, nentries = (%lld) > INT_MAX unsupported \n ",
-	      nentries64_t);
-      return false;
-    }
-    else
-      nentries = (int)nentries64_t;
+    // all files of a chain
+    nentries = rawTree->GetEntries();
   
     startTime = GetTrigTimeTag(0);
     
   }
 
+  InitCommon();
+
+  return true;
+}
+
+bool TCooker::Init(WaveDumpReader * reader)
+{
+  printf("\n ------------------------------ \n");
+  printf("\n Initialising Binary Data \n");
+  
+  nentries = 0;
+  
+  if (!reader || !reader->IsOpen()){
+    fprintf( stderr, "\n Error: binary file not open \n ");
+    return false;
+  }
+  
+  // sample word size
+  if (reader->GetDigitiser() != fDigitiser){
+    fprintf( stderr, "\n Error: binary file opened for another digitiser \n ");
+    return false;
+  }
+  
+  datReader = reader;
+  ADC       = &ADC_dat;
+  
+  // use an existing event index (dat_to_root -i Y)
+  // extending it, and saving it again, if the
+  // file has grown (so the next run, and each
+  // cooking thread, scans no headers). With 
+  // no index nothing is scanned: events are 
+  // assumed the size of the first
+  if( datReader->ReadIndex() ){
+    long long nIndexed = datReader->GetNEvents();
+    
+    datReader->BuildIndex();
+    
+    if( datReader->GetNEvents() != nIndexed )
+      datReader->WriteIndex();
+    
+    printf("\n   using %s \n",datReader->GetIndexPath().c_str());
+  }
+  
+  nentries = datReader->GetNEvents();
+  
+  startTime = GetTrigTimeTag(0);
+  
+  InitCommon();
+  
+  return true;
+}
+
+bool TCooker::Init(RawNTupleReader * reader)
+{
+  printf("\n ------------------------------ \n");
+  printf("\n Initialising RNTuple Data \n");
+  
+  nentries = 0;
+  
+#ifdef WITH_RNTUPLE
+  if (!reader || !reader->IsOpen()){
+    fprintf( stderr, "\n Error: raw RNTuple not open \n ");
+    return false;
+  }
+  
+  ntReader = reader;
+  ADC      = &ADC_dat;
+  
+  nentries = ntReader->GetEntries();
+  
+  startTime = GetTrigTimeTag(0);
+  
+  InitCommon();
+  
+  return true;
+#else
+  fprintf( stderr, "\n Error: built without RNTuple support (WITH_RNTUPLE) \n ");
+  return false;
+#endif
+}
+
+void TCooker::InitCommon()
+{
   // conversion factors
   SetConstants();
 
   SetStyle();
 
-  InitCanvas();
-
   printf("\n ------------------------------ \n");
-
-  return true;
 }
 
 
-void TCooker::Show(int entry)
+void TCooker::Show(Long64_t entry)
 {
    if (!rawTree) return;
    rawTree->Show(entry);
@@ -0,0 +1,72 @@
+#!/bin/bash
+
+# Cooks one run split over two raw files
+# as a single chain, as documented in
+# cook_raw.C, and checks it gives as many
+# cooked events as the unsplit run
+#
+# $ ./chain_test.sh /path/to/wave_0.dat [events in first file]
+#
+# needs dat_to_root (../Binary_Conversion)
+# and cook_raw built
+
+echo " -------------------------------"
+date
+echo "running"
+echo "chain_test.sh"
+echo " -------------------------------"
+
+DAT_TO_ROOT=$(realpath $(dirname $0)/../Binary_Conversion/dat_to_root)
+COOK_RAW=$(realpath $(dirname $0)/cook_raw)
+
+FILE_PATH=$1
+N_FIRST=${2:-1000}
+
+if [ ! -f "${FILE_PATH}" ]; then
+    echo " usage: chain_test.sh /path/to/wave_0.dat [events in first file]"
+    exit 1
+fi
+
+# file name conventions (see cook_raw.C)
+WORK_DIR=$(mktemp -d)
+RUN_DIR=${WORK_DIR}/RUN000001/PMT0001/Nominal
+
+mkdir -p ${RUN_DIR}
+ln -s $(realpath ${FILE_PATH}) ${RUN_DIR}/wave_0.dat
+
+cd ${RUN_DIR}
+
+# unsplit, from the binary file
+N_RUN=$(${COOK_RAW} wave_0.dat -v H 2>&1 | \
+	       sed -n 's/.*Cooked \([0-9]*\) events.*/\1/p')
+
+# two raw files: events 0 to N_FIRST-1, the rest
+${DAT_TO_ROOT} wave_0.dat -f 0 -n ${N_FIRST} > /dev/null 2>&1
+${DAT_TO_ROOT} wave_0.dat -f ${N_FIRST} > /dev/null 2>&1
+
+FIRST=$(ls wave_0.dat.0_*.root)
+SECOND=$(ls wave_0.dat.${N_FIRST}_*.root)
+
+OUTPUT=$(${COOK_RAW} ${FIRST} ${SECOND} -c Y -o 2000 -v H 2>&1)
+
+N_FILES=$(echo "${OUTPUT}" | sed -n 's/.*Chaining \([0-9]*\) files.*/\1/p')
+N_CHAIN=$(echo "${OUTPUT}" | sed -n 's/.*Cooked \([0-9]*\) events.*/\1/p')
+
+cd - > /dev/null
+rm -rf ${WORK_DIR}
+
+printf "\n %s + %s \n" "${FIRST}" "${SECOND}"
+printf "\n  chained files   %s \n" "${N_FILES}"
+printf "  cooked (chain)  %s \n" "${N_CHAIN}"
+printf "  cooked (run)    %s \n" "${N_RUN}"
+
+echo " ------------------------------"
+date
+echo " ------------------------------"
+
+if [ "${N_FILES}" != "2" ] || [ -z "${N_RUN}" ] || [ "${N_CHAIN}" != "${N_RUN}" ]; then
+    echo " FAILED"
+    exit 1
+fi
+
+echo " PASSED"
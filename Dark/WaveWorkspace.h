@@ -0,0 +1,103 @@
+/***************************************************
+ * Per-event waveform workspace for dark
+ *
+ * Purpose
+ *  The dark count checks (baseline, max of the
+ *  corrected waveform, rise before the peak)
+ *  all work on one waveform in mV. It is
+ *  converted from ADC once per event into
+ *  buffers sized once per file (Init), so no
+ *  memory is allocated per event.
+ *
+ *  One workspace per thread; it holds no
+ *  globals so dark_bench can time and check it
+ *  standalone.
+ *
+ *  Results are bit-exact with the base() and 
+ *  peak_rise() that dark.cc had before them 
+ *  (dark_bench), both using FitLine. FitLine 
+ *  itself replaced two TH1F Fit("pol1","Q") 
+ *  slope corrections; fit_check compares it
+ *  with root's fits (each fit's parameters,
+ *  the baseline and corrected waveform).
+ *
+ * Usage
+ *  WaveWorkspace workspace;
+ *  workspace.Init(constants);
+ *
+ *  // each event
+ *  workspace.Load(ADC->data());
+ *  double baseline = workspace.Baseline();
+ *  double max_mV   = workspace.MaxCorrected();
+ *  int    rise     = workspace.PeakRise(base_mV,
+ *                                       peak_mV,
+ *                                       peak_samp);
+ *
+ */
+
+#ifndef WaveWorkspace_h
+#define WaveWorkspace_h
+
+#include <vector>
+
+using namespace std;
+
+// meta data (see InitMeta)
+struct DarkConstants {
+  short nSamples  = 0;
+  short range_V   = 2;
+  float mVPerBin  = 0.;
+  float ampGain   = 10.;
+  float nsPerSamp = 0.;
+  float length_ns = 0.;
+};
+
+// least squares line through (x0 + i*dx, y[i]),
+// closed form of the TH1F pol1 chi2 fits it
+// replaces: float bin contents, bin errors
+// sqrt(|y|), empty bins skipped
+void FitLine(const double * y, int n,
+	     double x0, double dx,
+	     double * p0, double * p1);
+
+class WaveWorkspace {
+public:
+
+  // buffers sized for nSamples
+  void   Init(const DarkConstants & constants);
+
+  // ADC to mV, as ADC_To_Wave
+  void   Load(const short * ADC);
+
+  // baseline (mV) after linear slope corrections
+  // before and after outlier removal, keeps the
+  // corrected waveform
+  double Baseline();
+
+  // of the corrected waveform (after Baseline)
+  double MaxCorrected() const;
+
+  // 1 if the nbins samples up to peak_samp
+  // rise through base_mV + 0.25*peak_mV,
+  // 0 if none or all of them are above it
+  int    PeakRise(float base_mV,
+		  float peak_mV,
+		  short peak_samp,
+		  int   nbins = 10) const;
+
+  const float  * GetWave()      const { return fWave.data(); }
+  const double * GetCorrected() const { return fCorrected.data(); }
+
+private:
+
+  DarkConstants  fC;
+
+  // mV, one conversion per event
+  vector<float>  fWave;
+  // after Baseline()
+  vector<double> fCorrected;
+  // samples within 1 sdev
+  vector<double> fKept;
+};
+
+#endif
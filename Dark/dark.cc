@@ -1,20 +1,62 @@
 #include "dark.h"
 
 //------------------------------
-void Noise(){
+bool Noise(){
   
   InitNoise();
   
-  for (int iEntry = 0; iEntry < nentries; iEntry++) {
-    cookedTree->GetEntry(iEntry);
-
-    hMean_Cooked->Fill(mean_mV);
-    hPPV_Cooked->Fill(peak_mV-min_mV);
-    hPeak_Cooked->Fill(peak_mV);
-    hMin_Cooked->Fill(min_mV);
-    hMin_Peak_Cooked->Fill(min_mV,peak_mV);
+  vector<NoiseHists> hists(NThreads);
+  
+  for( int iThread = 0 ; iThread < NThreads ; iThread++ ){
+    hists[iThread].hMean     = ThreadHist(hMean_Cooked,iThread);
+    hists[iThread].hPPV      = ThreadHist(hPPV_Cooked,iThread);
+    hists[iThread].hPeak     = ThreadHist(hPeak_Cooked,iThread);
+    hists[iThread].hMin      = ThreadHist(hMin_Cooked,iThread);
+    hists[iThread].hMin_Peak = ThreadHist(hMin_Peak_Cooked,iThread);
+  }
+  
+  vector<DarkRange> ranges = GetDarkRanges();
+  
+  auto process = [&](int iThread, DarkInput & in, DarkRange & range){
+    
+    NoiseHists & h = hists[iThread];
     
-   }
+    for (Long64_t iEntry = range.first; iEntry < range.first + range.n; iEntry++) {
+      if( in.GetEntry(iEntry) <= 0 ){
+	fprintf( stderr, "\n Error: entry %lld not read \n ",iEntry);
+	return false;
+      }
+      
+      h.hMean->Fill(in.mean_mV);
+      h.hPPV->Fill(in.peak_mV-in.min_mV);
+      h.hPeak->Fill(in.peak_mV);
+      h.hMin->Fill(in.min_mV);
+      h.hMin_Peak->Fill(in.min_mV,in.peak_mV);
+    }
+    
+    return true;
+  };
+  
+  bool complete = ForEachRange(ranges,process,[](DarkRange &){});
+  
+  for( int iThread = 1 ; iThread < NThreads ; iThread++ ){
+    AddThreadHist(hists[0].hMean,hists[iThread].hMean);
+    AddThreadHist(hists[0].hPPV,hists[iThread].hPPV);
+    AddThreadHist(hists[0].hPeak,hists[iThread].hPeak);
+    AddThreadHist(hists[0].hMin,hists[iThread].hMin);
+    AddThreadHist(hists[0].hMin_Peak,hists[iThread].hMin_Peak);
+  }
+  
+  AddThreadHist(hMean_Cooked,hists[0].hMean);
+  AddThreadHist(hPPV_Cooked,hists[0].hPPV);
+  AddThreadHist(hPeak_Cooked,hists[0].hPeak);
+  AddThreadHist(hMin_Cooked,hists[0].hMin);
+  AddThreadHist(hMin_Peak_Cooked,hists[0].hMin_Peak);
+  
+  if( !complete ){
+    fprintf( stderr, "\n Error: noise analysis incomplete \n ");
+    return false;
+  }
   
   // find peak of mean voltage in mV
   int     max_bin_mean = hMean_Cooked->GetMaximumBin();
@@ -29,7 +71,7 @@ void Noise(){
   
   // standard threshold rel mean peak
   int thresh_bin   = hMin_Cooked->FindBin(noise_thresh_mV);
-  int noise_counts = hMin_Cooked->Integral(0,thresh_bin);
+  Long64_t noise_counts = hMin_Cooked->Integral(0,thresh_bin);
   
   float noise_rate = (float)noise_counts/nentries;
   noise_rate = noise_rate/Length_ns * 1.0e9;
@@ -47,6 +89,7 @@ void Noise(){
 
   SaveNoise();
 
+  return true;
 }
 
 void InitNoise(){
@@ -62,6 +105,15 @@ void InitNoise(){
   float maxX     =  range/2.;
   int   nBins    = 0;
   
+  // plotted region, full range grid
+  HistWindow minWin  = { -50., 50.};
+  HistWindow peakWin = { -50.,150.};
+  
+  hMin_Peak_Cooked = NewWindowTH2F("hMin_Peak_Cooked",
+				   "peak vs min ; min voltage (mV);peak voltage (mV)",
+				   minX,binWidth,
+				   minWin,peakWin);
+  
   // fix binning and set number of bins
   Set_THF_Params(&minX,&maxX,&binWidth,&nBins);
   
@@ -77,11 +129,6 @@ void InitNoise(){
 			  ";min voltage (mV);Counts",
 			  nBins,minX,maxX);
 
-  hMin_Peak_Cooked =  new TH2F("hMin_Peak_Cooked",
-			       "peak vs min ; min voltage (mV);peak voltage (mV)",
-			       nBins,minX,maxX,
-			       nBins,minX,maxX);
-
   // prepare for range starting at zero
   minX = 0.0;
   maxX = range/2.;
@@ -98,226 +145,236 @@ void InitNoise(){
 
 void SaveNoise(string outPath){
 
-  string sys_command = "mkdir -p ";
-  sys_command += outPath;
-  gSystem->Exec(sys_command.c_str());
+  if( PlotOutput == 'P' ){
+    string sys_command = "mkdir -p ";
+    sys_command += outPath;
+    gSystem->Exec(sys_command.c_str());
+  }
   
   printf("\n Saving Noise Monitoring Plots \n\n");
 
-  InitCanvas();
-  
-  gPad->SetLogy();
+  PlotStore * plots = GetPlots();
   
   hMean_Cooked->SetAxisRange(-30., 120.,"X");
   hMean_Cooked->SetMinimum(0.1);
-  hMean_Cooked->Draw();
 
-  string outName = outPath + "hMean_Cooked.pdf";
-  canvas->SaveAs(outName.c_str());  
+  plots->Add(hMean_Cooked,outPath + "hMean_Cooked.pdf","logy");
   
   hPPV_Cooked->SetAxisRange(-5.0, 145.,"X");
   hPPV_Cooked->SetMinimum(0.1);
-  hPPV_Cooked->Draw();
   
-  outName = outPath + "hPPV_Cooked.pdf";
-  canvas->SaveAs(outName.c_str());
+  plots->Add(hPPV_Cooked,outPath + "hPPV_Cooked.pdf","logy");
   
   hPeak_Cooked->SetAxisRange(-20.,80.,"X");
   hPeak_Cooked->SetMinimum(0.1);
-  hPeak_Cooked->Draw();
-  outName = outPath + "hPeak_Cooked.pdf";
-  canvas->SaveAs(outName.c_str());
-  
+
+  plots->Add(hPeak_Cooked,outPath + "hPeak_Cooked.pdf","logy");
   
   hMin_Cooked->SetAxisRange(-30.,20.,"X");
   hMin_Cooked->SetMinimum(0.1);
-  hMin_Cooked->Draw();
 
   TLine * l_thresh = new TLine(noise_thresh_mV,1,noise_thresh_mV,1000);
   l_thresh->SetLineStyle(2);
   l_thresh->SetLineColor(kRed);
   l_thresh->SetLineWidth(2);
-  l_thresh->Draw();
   
   TLine * l_th_low = new TLine(noise_th_low_mV,1,noise_th_low_mV,1000);
   l_th_low->SetLineStyle(2);
   l_th_low->SetLineColor(kBlue);
   l_th_low->SetLineWidth(2);
-  l_th_low->Draw();
   
-  outName = outPath + "hMin_Cooked.pdf";
-  canvas->SaveAs(outName.c_str());
+  // drawn with (and saved in) the histogram
+  hMin_Cooked->GetListOfFunctions()->Add(l_thresh);
+  hMin_Cooked->GetListOfFunctions()->Add(l_th_low);
   
-  gPad->SetLogy(false);
-  gPad->SetLogz();
+  plots->Add(hMin_Cooked,outPath + "hMin_Cooked.pdf","logy");
   
   hMin_Peak_Cooked->SetAxisRange(-25., 15.,"X");
   hMin_Peak_Cooked->SetAxisRange(-15., 50.,"Y");
+  hMin_Peak_Cooked->SetOption("colz");
   
-  hMin_Peak_Cooked->Draw("colz");
-
-  outName = outPath + "hMin_Peak_Cooked.pdf";
-  canvas->SaveAs(outName.c_str());
-
-  gPad->SetLogz(false);
-  
-  delete canvas;
+  plots->Add(hMin_Peak_Cooked,outPath + "hMin_Peak_Cooked.pdf","logz");
   
 }
 
-std::pair<double,std::vector<double>> base(int iEntry){
-
-  // determine waveform, mean amplitude in mV
-
-  std::vector<double> amplitude;
-  for( int iSamp = 0 ; iSamp < NSamples; iSamp++){
-    amplitude.push_back(ADC_To_Wave(ADC->at(iSamp)));
-  }
-  
-  double mean = std::accumulate(amplitude.begin(), amplitude.end(), 0.0);
-  mean /= NSamples;
-    
-  // baseline subtraction
+bool Dark(float thresh_mV){
   
-  std::vector<double> base_sub;
-  for( int iSamp = 0; iSamp < NSamples; iSamp++){
-    base_sub.push_back(amplitude[iSamp]-mean);
-  }
-  
-  // first linear regression
-  
-  TH1F* lin_reg1 = new TH1F("lin_reg1","First linear slope correction",base_sub.size(),0,Length_ns);
-  for (int iSamp = 0; iSamp < NSamples; iSamp++){
-    lin_reg1->SetBinContent(iSamp+1,base_sub[iSamp]);
-  }
+  InitDark();
   
-  lin_reg1->Fit("pol1","Q");
+  float darkRate = 0;
+  float darkRateErr = 0;
+  float darkRate_noise = 0;
+  float darkRateErr_noise = 0;
   
-  double p0_lin1 = lin_reg1->GetFunction("pol1")->GetParameter(0);
-  double p1_lin1 = lin_reg1->GetFunction("pol1")->GetParameter(1);
+  Long64_t av_neg_rej = 0;
+  Long64_t av_pos_rej = 0;
   
-  delete lin_reg1;
+  // event lists written during the pass,
+  // renamed once all entries are read
+  vector<string> csvNames = {"rejected_waveforms.csv",
+			     "dark_hits.csv",
+			     "unchecked_hits.csv"};
   
-  // first linear regression correction
+  std::ofstream rejected_waveforms;
+  rejected_waveforms.open("rejected_waveforms.csv.part");
+  rejected_waveforms << "Rejected waveform at entry\n";
   
-  std::vector<double> base_lin1;
-  for( int iSamp = 0; iSamp < NSamples; iSamp++){
-    base_lin1.push_back(base_sub[iSamp] - p0_lin1 - (p1_lin1*iSamp*nsPerSamp));
-  }
+  std::ofstream dark_csv;
+  dark_csv.open ("dark_hits.csv.part");
+  dark_csv << "Count at entry\n";
   
-  // variance/stdev
+  std::ofstream unchecked_csv;
+  unchecked_csv.open ("unchecked_hits.csv.part");
+  unchecked_csv << "Unchecked (no waveform) at entry\n";
   
-  double var = 0.;
+  vector<DarkThread> threads(NThreads);
   
-  for (int iSamp = 0; iSamp < NSamples; iSamp++){
-    var += pow(base_lin1[iSamp]-mean,2);
+  for( int iThread = 0 ; iThread < NThreads ; iThread++ ){
+    threads[iThread].hD_Peak     = ThreadHist(hD_Peak,iThread);
+    threads[iThread].hD_Min_Peak = ThreadHist(hD_Min_Peak,iThread);
+    
+    // mV waveform and its baseline
+    // correction, sized once
+    threads[iThread].workspace.Init(GetDarkConstants());
   }
-
-  var /= NSamples;
-  double sdev = sqrt(var);
   
-  // outlier removal
+  vector<DarkRange> ranges = GetDarkRanges();
   
-  std::vector<double> base_out;
-  //printf("base_out = [");
-  for (int iSamp = 0; iSamp < NSamples; iSamp++){
-    if (sqrt(pow(base_lin1[iSamp]-mean,2)) >= 1*sdev){
-      continue;
+  auto process = [&](int iThread, DarkInput & in, DarkRange & range){
+    
+    DarkThread    & t         = threads[iThread];
+    WaveWorkspace & workspace = t.workspace;
+    
+    for (Long64_t iEntry = range.first; iEntry < range.first + range.n; iEntry++) {
+      if( in.GetEntry(iEntry) <= 0 ){
+	fprintf( stderr, "\n Error: entry %lld not read \n ",iEntry);
+	return false;
+      }
+      
+      float peak_mV = in.peak_mV;
+      float min_mV  = in.min_mV;
+      
+      if(peak_mV > thresh_mV)
+	t.nDark_noise++;
+      
+      // Noise Rejection 
+      if( min_mV < -2.5 && peak_mV < thresh_mV){
+	continue;}
+      
+      if( peak_mV < -2*min_mV && peak_mV > thresh_mV ){
+	continue;}
+      
+      if( peak_mV < 2*min_mV && peak_mV > thresh_mV ){
+	continue;}
+      
+      t.hD_Peak->Fill(peak_mV);
+      t.hD_Min_Peak->Fill(min_mV,peak_mV);
+      
+      if( peak_mV < thresh_mV){
+	t.peak_low++;
+	continue;}
+      
+      // no baseline or rise time checks,
+      // so neither counted nor rejected
+      if( !in.HasWaveform() && !in.LoadWaveform() ){
+	range.unchecked.push_back(iEntry);
+	t.unchecked++;
+	continue;}
+      
+      workspace.Load(in.ADC->data());
+      
+      double baseline = workspace.Baseline();
+      double max_mV   = workspace.MaxCorrected();
+      
+      if(max_mV > 80+baseline){
+	range.rejected.push_back(iEntry);
+	t.rejected++;
+	t.peak_high++;
+	continue;}
+      
+      if(max_mV < thresh_mV+baseline){
+	range.rejected.push_back(iEntry);
+	t.rejected++;
+	t.peak_low++;
+	continue;}
+      
+      int rise = workspace.PeakRise(in.base_mV,peak_mV,in.peak_samp);
+      
+      if(!rise){
+	range.rejected.push_back(iEntry);
+	t.rise_rej++;
+	continue;}
+      
+      range.hits.push_back(iEntry);
+      
+      t.nDark++;
     }
-    else
-      base_out.push_back(base_lin1[iSamp]);
-  }
-  
-  // second mean baseline
+    
+    return true;
+  };
   
-  double mean2 = std::accumulate(base_out.begin(), base_out.end(), 0.0);
-  mean2 /= NSamples;
+  // entry order, as a serial run
+  auto merge = [&](DarkRange & range){
     
-  // second baseline subtraction
-  std::vector<double> base_all_sub2;
-  std::vector<double> base_sub2;
-  int NSamples_removed = base_out.size();
-  for( int iSamp = 0; iSamp < NSamples_removed; iSamp++){
-    base_sub2.push_back(base_out[iSamp]-mean2); //apply to data with AND without outlier
-  }
-  //printf("]\n");
-  for( int iSamp = 0; iSamp < NSamples; iSamp++){
-    base_all_sub2.push_back(base_lin1[iSamp]-mean2); //apply to data with AND without outlier
-  }
-
-  // second linear regression
+    for( Long64_t iEntry : range.hits )
+      dark_csv << iEntry << "\n";
+    
+    for( Long64_t iEntry : range.rejected )
+      rejected_waveforms << iEntry << "\n";
+    
+    for( Long64_t iEntry : range.unchecked )
+      unchecked_csv << iEntry << "\n";
+  };
   
-  TH1F* lin_reg2 = new TH1F("lin_reg2","Second linear slope correction",NSamples_removed,0,nsPerSamp*NSamples_removed);
-  for (int iSamp = 0; iSamp < NSamples_removed; iSamp++){
-    lin_reg2->SetBinContent(iSamp+1,base_sub2[iSamp]);
-  }
+  bool complete = ForEachRange(ranges,process,merge);
   
-  lin_reg2->Fit("pol1","Q");
+  Long64_t nDark = 0;
+  Long64_t nDark_noise = 0;
   
-  double p0_lin2 = lin_reg2->GetFunction("pol1")->GetParameter(0);
-  double p1_lin2 = lin_reg2->GetFunction("pol1")->GetParameter(1);
+  Long64_t rejected = 0;
   
-  delete lin_reg2;
+  Long64_t rise_rej = 0;
+  Long64_t peak_low = 0;
+  Long64_t peak_high = 0;
   
-  // second linear regression correction
+  Long64_t unchecked = 0;
   
-  std::vector<double> base_lin_all2;
-  for( int iSamp = 0; iSamp < NSamples; iSamp++){
-    base_lin_all2.push_back(base_all_sub2[iSamp] - p0_lin2 - (p1_lin2*iSamp*nsPerSamp)); //Fit to data without outlier, correct data with outlier
-  }
-
-  std::vector<double> base_lin2;// = base_sub2;
-  //printf("baseline2 = [");
-  for( int iSamp = 0; iSamp < NSamples_removed; iSamp++){
-    base_lin2.push_back(base_sub2[iSamp] - p0_lin2 - (p1_lin2*iSamp*nsPerSamp)); //Fit to data without outlier, correct data with outlier
+  for( int iThread = 0 ; iThread < NThreads ; iThread++ ){
+    DarkThread & t = threads[iThread];
+    
+    nDark       += t.nDark;
+    nDark_noise += t.nDark_noise;
+    rejected    += t.rejected;
+    rise_rej    += t.rise_rej;
+    peak_low    += t.peak_low;
+    peak_high   += t.peak_high;
+    unchecked   += t.unchecked;
+    
+    if( iThread > 0 ){
+      AddThreadHist(threads[0].hD_Peak,t.hD_Peak);
+      AddThreadHist(threads[0].hD_Min_Peak,t.hD_Min_Peak);
+    }
   }
   
-  // final mean to give baseline in mV -> surely need whole corrected data set?
-  
-  double baseline = std::accumulate(base_lin2.begin(), base_lin2.end(), 0.0);
-  baseline /= NSamples;
+  AddThreadHist(hD_Peak,threads[0].hD_Peak);
+  AddThreadHist(hD_Min_Peak,threads[0].hD_Min_Peak);
   
-  return std::make_pair(baseline,base_lin_all2);
-
-}
-
-int peak_rise(float thresh_mV, int nbins){
-
-  double thresh = base_mV+0.25*peak_mV;//base_mV + thresh_mV;
+  rejected_waveforms.close();
+  dark_csv.close();
+  unchecked_csv.close();
   
-  std::vector<double> amplitude;
-
-  for( short iSamp = 0 ; iSamp < NSamples; iSamp++)
-    amplitude.push_back(ADC_To_Wave(ADC->at(iSamp)));
+  // no results from a partial pass
+  if( !complete ){
+    fprintf( stderr, "\n Error: dark analysis incomplete, no results written \n ");
     
-  int bins = 0;
+    for( const string & name : csvNames )
+      gSystem->Unlink((name + ".part").c_str());
     
-  for( int iSamp_peak = peak_samp; iSamp_peak > peak_samp - nbins; iSamp_peak--){
-    if(amplitude[iSamp_peak] > thresh)
-      bins++;
-    else
-      break;
+    return false;
   }
-    
-  if(bins == 0)
-    return 0;  
-  else if(bins == nbins)
-    return 0;
-  else
-    return 1;
-    
-  //first analysis uses 6 bins, base_mV + thresh_mV, 10 mV thresh, no bins == 0 condition
-  
-}
-
-void Dark(float thresh_mV){
-  
-  InitDark();
   
-  float darkRate = 0;
-  float darkRateErr = 0;
-  float darkRate_noise = 0;
-  float darkRateErr_noise = 0;
+  for( const string & name : csvNames )
+    gSystem->Rename((name + ".part").c_str(),name.c_str());
   
   TFile* results = new TFile("dark_results.root","RECREATE");  
   TTree* Dark = new TTree("Dark","Dark");
@@ -326,81 +383,6 @@ void Dark(float thresh_mV){
   Dark->Branch("darkRate_noise",&darkRate_noise,"darkRate/F");
   Dark->Branch("darkRateErr_noise",&darkRateErr_noise,"darkRateErr/F");
   
-  int nDark = 0;
-  int nDark_noise = 0;
-  
-  int rejected = 0;
-  
-  int rise_rej = 0;
-  int av_neg_rej = 0;
-  int av_pos_rej = 0;
-  int peak_low = 0;
-  int peak_high = 0;
-  
-  std::ofstream rejected_waveforms;
-  rejected_waveforms.open("rejected_waveforms.csv");
-  rejected_waveforms << "Rejected waveform at entry\n";
-
-  std::ofstream dark_csv;
-  dark_csv.open ("dark_hits.csv");
-  dark_csv << "Count at entry\n";
-  
-  for (int iEntry = 0; iEntry < nentries; iEntry++) {
-    cookedTree->GetEntry(iEntry);
-    if(peak_mV > thresh_mV)
-      nDark_noise++;
-
-    // Noise Rejection 
-    if( min_mV < -2.5 && peak_mV < thresh_mV){
-      continue;}
-    
-    if( peak_mV < -2*min_mV && peak_mV > thresh_mV ){
-      continue;}
-      
-    if( peak_mV < 2*min_mV && peak_mV > thresh_mV ){
-      continue;}
-      
-    hD_Peak->Fill(peak_mV);
-    hD_Min_Peak->Fill(min_mV,peak_mV);
-    
-    if( peak_mV < thresh_mV){
-      peak_low++;
-      continue;}
-    
-    std::pair<double,std::vector<double>> base_corrections = base(iEntry);
-    double baseline = base_corrections.first;
-    std::vector<double> wave_corrected = base_corrections.second;
-    auto max_wave = std::max_element(wave_corrected.begin(), wave_corrected.end());
-    double max_mV = *max_wave;
-
-    if(max_mV > 80+baseline){
-      rejected_waveforms << iEntry << "\n";
-      rejected++;
-      peak_high++;
-      continue;}
-
-    if(max_mV < thresh_mV+baseline){
-      rejected_waveforms << iEntry << "\n";
-      rejected++;
-      peak_low++;
-      continue;}
-    
-    int rise = peak_rise();
-    
-    if(!rise){
-      rejected_waveforms << iEntry << "\n";
-      rise_rej++;
-      continue;}
-    
-    dark_csv << iEntry << "\n";
-    
-    nDark++;
-    
-  }
-
-  rejected_waveforms.close();
-  dark_csv.close();
-  
   std::ofstream rej_count;
   rej_count.open("rejected_types.csv");
   rej_count << "peak_low,av_neg_rej,av_pos_rej,peak_high,rise_rej\n";
@@ -413,15 +395,33 @@ void Dark(float thresh_mV){
   darkRate = darkRate/Length_ns * 1.0e9;
   darkRateErr = darkErr/nDark * darkRate;
   
-  printf("\n \n nentries = %d \n",nentries);
-  printf("\n %i rejected 'dark counts'\n",rejected);
-  printf("\n dark counts (noise rejected) = %d +/- %.0f \n",nDark,darkErr);
+  printf("\n \n nentries = %lld \n",nentries);
+  printf("\n %lld rejected 'dark counts'\n",rejected);
+  
+  printf("\n dark counts (noise rejected) = %lld +/- %.0f \n",nDark,darkErr);
   printf("\n dark rate   (noise rejected) = %.0f +/- %.0f Hz \n",darkRate,darkRateErr);
   
+  // candidates with no waveform in the cooked
+  // file (-a P/S) and no raw file to read it
+  // from: the rate is a lower bound
+  float darkRate_unchecked = (float)(nDark+unchecked)/(nentries-rejected);
+  darkRate_unchecked = darkRate_unchecked/Length_ns * 1.0e9;
+  
+  if( unchecked > 0 ){
+    fprintf( stderr, "\n Warning: %lld candidates passed the scalar cuts but have no waveform to check \n ",
+	     unchecked);
+    fprintf( stderr, "\n          (unchecked_hits.csv), not counted: dark rate between %.0f and %.0f Hz \n ",
+	     darkRate,darkRate_unchecked);
+  }
+  
   std::ofstream dark_results;
   dark_results.open ("dark_results.txt");
   dark_results << "dark counts (noise rejected) = " << nDark << " +/- " << darkErr << "\n";
   dark_results << "dark noise (noise rejected) = " << darkRate << " +/- " << darkRateErr << " Hz\n";
+  if( unchecked > 0 ){
+    dark_results << "unchecked (no waveform) = " << unchecked << "\n";
+    dark_results << "dark noise (with unchecked) = " << darkRate_unchecked << " Hz\n";
+  }
   dark_results.close();
   
   float darkErr_noise = sqrt(nDark_noise);
@@ -430,7 +430,7 @@ void Dark(float thresh_mV){
   darkRate_noise = darkRate_noise/Length_ns * 1.0e9;
   darkRateErr_noise = darkErr_noise/nDark_noise * darkRate_noise;
   
-  printf("\n dark counts (with noise) = %d +/- %.0f \n",nDark_noise,darkErr_noise);
+  printf("\n dark counts (with noise) = %lld +/- %.0f \n",nDark_noise,darkErr_noise);
   printf("\n dark rate   (with noise) = %.0f +/- %.0f Hz\n\n",darkRate_noise,darkRateErr_noise);
   
   std::ofstream dark_results_noise;
@@ -445,6 +445,7 @@ void Dark(float thresh_mV){
   Dark->Write();
   results->Close();
   
+  return true;
 }
 
 void InitDark(){
@@ -459,70 +460,290 @@ void InitDark(){
   float binWidth = Wave_To_Amp_Scaled_Wave(mVPerBin);
   int   nBins    = 0;
 
+  // plotted region, full range grid
+  HistWindow minWin  = { -50., 50.};
+  HistWindow peakWin = { -50.,150.};
+  
+  hD_Min_Peak = NewWindowTH2F("hD_Min_Peak",
+			      "hD_Min_Peak;min voltage (mV);peak voltage (mV)",
+			      min,binWidth,
+			      minWin,peakWin);
+  
   //  fix binning and set number of bins
   Set_THF_Params(&min,&max,&binWidth,&nBins);
   
   hD_Peak = new TH1F("hD_Peak",
 		     "hD_Peak;peak voltage (mV);Counts",
 		     nBins,min,max);
-  
-  hD_Min_Peak = new TH2F("hD_Min_Peak",
-			 "hD_Min_Peak;min voltage (mV);peak voltage (mV)",
-			 nBins,min,max,
-			 nBins,min,max);
 
 }
 
 void SaveDark(string outPath){
 
-  string sys_command = "mkdir -p ";
-  sys_command += outPath;
-  gSystem->Exec(sys_command.c_str());
-
-  InitCanvas();
-
-  TLegend *leg = new TLegend(0.21,0.2,0.31,0.9);
-    
-  leg->SetTextSize(0.025);
-  leg->SetHeader("Baseline start","C");
-  
-  leg->SetMargin(0.4); 
+  if( PlotOutput == 'P' ){
+    string sys_command = "mkdir -p ";
+    sys_command += outPath;
+    gSystem->Exec(sys_command.c_str());
+  }
 
-  gPad->SetLogy();
+  PlotStore * plots = GetPlots();
   
   hD_Peak->SetAxisRange(-5., 75.,"X");
   hD_Peak->SetMinimum(0.1);
-  hD_Peak->Draw();
   
   TLine * lVert = new TLine(10,0,10,20);
   lVert->SetLineColor(kBlue);
   lVert->SetLineWidth(2);
   lVert->SetLineStyle(2);
-  lVert->Draw();
-
-  string outName = outPath + "hD_Peak.pdf";
-  canvas->SaveAs(outName.c_str());
+  
+  hD_Peak->GetListOfFunctions()->Add(lVert);
 
-  gPad->SetLogy(false);
+  plots->Add(hD_Peak,outPath + "hD_Peak.pdf","logy");
 
-  gPad->SetLogz();
   hD_Min_Peak->SetAxisRange(-25.,25.,"X");
   hD_Min_Peak->SetAxisRange(-5., 45.,"Y");
+  hD_Min_Peak->SetOption("col");
+  
+  plots->Add(hD_Min_Peak,outPath + "hD_Min_Peak.pdf","logz grid");
   
-  gPad->SetGrid(1, 1);
-  hD_Min_Peak->Draw("col");
+}
+
+PlotStore * GetPlots(){
   
-  gPad->SetLogz();
+  if( !plots ){
+    gSystem->mkdir("./Plots",true);
+    
+    string summaryPath = "./Plots/";
+    summaryPath += FileID;
+    summaryPath += "_dark.root";
+    
+    plots = new PlotStore(PlotOutput,summaryPath);
+  }
   
-  outName = outPath + "hD_Min_Peak.pdf";
-  canvas->SaveAs(outName.c_str());
+  return plots;
+}
 
-  gPad->SetGrid(0,0);
+void SetNThreads(int nThreads){
+  
+  if( nThreads < 1 )
+    nThreads = (int)thread::hardware_concurrency();
+  
+  if( nThreads < 1 )
+    nThreads = 1;
   
-  gPad->SetLogz(false);
+  NThreads = nThreads;
+}
 
-  delete canvas;
+vector<DarkRange> GetDarkRanges(){
+  
+  vector<DarkRange> ranges;
+  
+  // about 4 MB of cooked waveforms per range
+  Long64_t minEntries = max(1000,(1 << 21)/max((int)NSamples,1));
+  
+  // own chain for a run's parts
+  TTree * tree = nullptr;
+  
+  CookedTreeReader * treeReader = dynamic_cast<CookedTreeReader*>(cookedReader);
+  
+  if( treeReader && !treeReader->GetTree()->InheritsFrom(TChain::Class()) )
+    tree = treeReader->GetTree();
+  
+  Long64_t first = 0;
   
+  auto AddRange = [&](Long64_t end){
+    ranges.emplace_back();
+    ranges.back().first = first;
+    ranges.back().n     = end - first;
+    first = end;
+  };
+  
+  if( tree ){
+    TTree::TClusterIterator clusters = tree->GetClusterIterator(0);
+    
+    Long64_t start;
+    
+    while( (start = clusters()) < nentries ){
+      Long64_t end = min(clusters.GetNextEntry(),nentries);
+      
+      if( end - first >= minEntries )
+	AddRange(end);
+    }
+  }
+  else
+    while( nentries - first > minEntries )
+      AddRange(first + minEntries);
+  
+  if( first < nentries )
+    AddRange(nentries);
+  
+  return ranges;
+}
+
+bool ForEachRange(vector<DarkRange> & ranges,
+		  function<bool(int,DarkInput&,DarkRange&)> process,
+		  function<void(DarkRange&)> merge){
+  
+  int nRanges  = (int)ranges.size();
+  int nThreads = min(NThreads,max(nRanges,1));
+  
+  // serial
+  if( nThreads == 1 ){
+    DarkInput input;
+    
+    if( !input.IsOpen() ){
+      fprintf( stderr, "\n Error: cooked data not opened \n ");
+      return false;
+    }
+    
+    for( auto & range : ranges ){
+      if( !process(0,input,range) )
+	return false;
+      
+      merge(range);
+      range = DarkRange();
+    }
+    
+    return true;
+  }
+  
+  printf("\n Analysing on %d threads \n",nThreads);
+  
+  ROOT::EnableThreadSafety();
+  
+  // ranges waiting to be merged are 
+  // limited to two per thread
+  int window = 2*nThreads;
+  
+  mutex              rangeMutex;
+  condition_variable rangeDone;
+  int                nMerged = 0;
+  atomic<int>        nextRange(0);
+  atomic<bool>       failed(false);
+  
+  auto worker = [&](int iThread){
+    
+    // stops the other threads and the merge
+    auto Fail = [&](){
+      {
+	lock_guard<mutex> lock(rangeMutex);
+	failed = true;
+      }
+      rangeDone.notify_all();
+    };
+    
+    DarkInput input;
+    
+    if( !input.IsOpen() ){
+      fprintf( stderr, "\n Error: cooked data not opened for analysis thread \n ");
+      Fail();
+      return;
+    }
+    
+    for( int iRange = nextRange++; iRange < nRanges; iRange = nextRange++ ){
+      
+      {
+	unique_lock<mutex> lock(rangeMutex);
+	rangeDone.wait(lock,[&]{ return failed || iRange < nMerged + window; });
+      }
+      
+      if( failed )
+	return;
+      
+      DarkRange & range = ranges[iRange];
+      
+      if( !process(iThread,input,range) ){
+	Fail();
+	return;
+      }
+      
+      {
+	lock_guard<mutex> lock(rangeMutex);
+	range.done = true;
+      }
+      rangeDone.notify_all();
+    }
+  };
+  
+  vector<thread> workers;
+  
+  for( int iThread = 0; iThread < nThreads; iThread++ )
+    workers.emplace_back(worker,iThread);
+  
+  for( int iRange = 0; iRange < nRanges; iRange++ ){
+    
+    DarkRange & range = ranges[iRange];
+    
+    {
+      unique_lock<mutex> lock(rangeMutex);
+      rangeDone.wait(lock,[&]{ return failed || range.done; });
+    }
+    
+    if( failed )
+      break;
+    
+    merge(range);
+    
+    // release the range's lists
+    range = DarkRange();
+    range.done = true;
+    
+    {
+      lock_guard<mutex> lock(rangeMutex);
+      nMerged++;
+    }
+    rangeDone.notify_all();
+  }
+  
+  for( auto & w : workers )
+    w.join();
+  
+  return !failed;
+}
+
+TH1D * ThreadHist(TH1F * hist, int iThread){
+  
+  TAxis * x = hist->GetXaxis();
+  
+  TH1D * copy = new TH1D(Form("%s_%d",hist->GetName(),iThread),
+			 hist->GetTitle(),
+			 x->GetNbins(),x->GetXmin(),x->GetXmax());
+  copy->SetDirectory(nullptr);
+  
+  return copy;
+}
+
+TH2D * ThreadHist(TH2F * hist, int iThread){
+  
+  TAxis * x = hist->GetXaxis();
+  TAxis * y = hist->GetYaxis();
+  
+  TH2D * copy = new TH2D(Form("%s_%d",hist->GetName(),iThread),
+			 hist->GetTitle(),
+			 x->GetNbins(),x->GetXmin(),x->GetXmax(),
+			 y->GetNbins(),y->GetXmin(),y->GetXmax());
+  copy->SetDirectory(nullptr);
+  
+  return copy;
+}
+
+void AddThreadHist(TH1 * hist, TH1 * threadHist){
+  hist->Add(threadHist);
+  delete threadHist;
+}
+
+DarkConstants GetDarkConstants(){
+  
+  DarkConstants constants;
+  
+  constants.nSamples  = NSamples;
+  constants.range_V   = Range_V;
+  constants.mVPerBin  = mVPerBin;
+  constants.ampGain   = AmpGain;
+  constants.nsPerSamp = nsPerSamp;
+  constants.length_ns = Length_ns;
+  
+  return constants;
 }
 
 float ADC_To_Wave(short ADC){
@@ -565,11 +786,85 @@ void InitCanvas(float w,float h){
   
 }
 
-int GetEntry(int entry)
+DarkInput::DarkInput(){
+  
+  CookedVars vars;
+  vars.ADC       = &ADC;
+  vars.peak_mV   = &peak_mV;
+  vars.peak_samp = &peak_samp;
+  vars.min_mV    = &min_mV;
+  vars.mean_mV   = &mean_mV;
+  vars.start_s   = &start_s;
+  vars.base_mV   = &base_mV;
+  vars.raw_entry = &raw_entry;
+  
+  // as InitCooked
+  if( inFileNames.size() > 1 )
+    fCooked = CookedReader::Open(inFileNames,GetCookedTreeID(),vars);
+  else{
+    fFile = TFile::Open(inFileNames[0].c_str(),"READ");
+    
+    if( fFile && !fFile->IsZombie() )
+      fCooked = CookedReader::Open(fFile,GetCookedTreeID(),vars);
+  }
+  
+  // as InitRaw, the linked files only
+#ifdef WITH_RNTUPLE
+  if( rawNTReader )
+    fRawNT = new RawNTupleReader(rawNTReader->GetFileName());
+#endif
+  
+  if( rawChain ){
+    fRawChain = new TChain("T");
+    
+    for( TObject * element : *rawChain->GetListOfFiles() )
+      fRawChain->Add(element->GetTitle());
+    
+    fRawChain->SetMakeClass(1);
+    
+    SetBranchAddress_ADC(fRawChain,&fRawADC,&fRawADC_arr,&fB_rawADC);
+  }
+}
+
+DarkInput::~DarkInput(){
+  
+  // a run's parts are read as a chain
+  CookedTreeReader * treeReader = dynamic_cast<CookedTreeReader*>(fCooked);
+  
+  if( treeReader && !fFile )
+    delete treeReader->GetTree();
+  
+  delete fCooked;
+  delete fFile;
+  
+  delete fRawChain;
+#ifdef WITH_RNTUPLE
+  delete fRawNT;
+#endif
+}
+
+bool DarkInput::IsOpen(){
+  return ( fCooked != nullptr );
+}
+
+int DarkInput::GetEntry(Long64_t entry){
+  fEntry = entry;
+  return fCooked->GetEntry(entry);
+}
+
+bool DarkInput::HasWaveform(){
+  
+  if( !fCooked->LoadADC(fEntry) )
+    return false;
+  
+  return ( ADC && (int)ADC->size() >= NSamples );
+}
+
+int GetEntry(Long64_t entry)
 {
 // Read contents of entry.
-   if (!cookedTree) return 0;
-   return cookedTree->GetEntry(entry);
+   if (!cookedReader) return 0;
+   return cookedReader->GetEntry(entry);
 }
 
 void Init()
@@ -623,6 +918,12 @@ void InitMeta(){
   metaTree->SetBranchAddress("Loc",&Loc,&b_Loc);
   metaTree->SetBranchAddress("Test",&Test,&b_Test);
   metaTree->SetBranchAddress("HVStep",&HVStep,&b_HVStep);
+  
+  // cook_raw -a and raw tree link
+  if( metaTree->GetBranch("PulsePol") )
+    metaTree->SetBranchAddress("PulsePol",&PulsePol);
+  if( metaTree->GetBranch("RawFile") )
+    metaTree->SetBranchAddress("RawFile",&RawFile);
 
   metaTree->GetEntry(0);
   
@@ -640,9 +941,24 @@ void InitMeta(){
 
 void InitCooked(){
   
-  inFile->GetObject(GetCookedTreeID().c_str(),cookedTree);
+  CookedVars vars;
+  vars.ADC       = &ADC;
+  vars.peak_mV   = &peak_mV;
+  vars.peak_samp = &peak_samp;
+  vars.min_mV    = &min_mV;
+  vars.mean_mV   = &mean_mV;
+  vars.start_s   = &start_s;
+  vars.base_mV   = &base_mV;
+  vars.raw_entry = &raw_entry;
+  
+  // TTree or RNTuple, or a 
+  // chain of a run's parts
+  if( inFileNames.size() > 1 )
+    cookedReader = CookedReader::Open(inFileNames,GetCookedTreeID(),vars);
+  else
+    cookedReader = CookedReader::Open(inFile,GetCookedTreeID(),vars);
   
-  if (cookedTree == 0){
+  if (cookedReader == 0){
     fprintf( stderr, "\n Warning: No cooked data tree");
   }
   
@@ -650,36 +966,155 @@ void InitCooked(){
   printf("\n Initialising Cooked Data \n");
   printf("\n   %s \n",GetCookedTreeID().c_str());
   
-  if (!cookedTree){
+  if (!cookedReader){
     fprintf( stderr, "\n Error: no cooked tree  \n ");
     return;
   }
+  
+  CookedTreeReader * treeReader = dynamic_cast<CookedTreeReader*>(cookedReader);
+  
+  if( !treeReader )
+    printf("\n   RNTuple \n");
+  else if( treeReader->GetLayout() == 'A' )
+    printf("\n   fixed length ADC layout \n");
+  else if( treeReader->GetLayout() == 0 )
+    printf("\n   no ADC branch (scalars only) \n");
+  
+  nentries = cookedReader->GetEntries();
+  
+  printf("\n   %lld entries \n",nentries);
+  
+  printf("\n ------------------------------ \n");
+  
+  return;
+}
 
-  cookedTree->SetMakeClass(1);
+void InitRaw(){
   
-  cookedTree->SetBranchAddress("ADC",&ADC, &b_ADC);
-  cookedTree->SetBranchAddress("peak_mV",&peak_mV, &b_peak_mV);
-  cookedTree->SetBranchAddress("peak_samp",&peak_samp, &b_peak_samp);
-  cookedTree->SetBranchAddress("min_mV",&min_mV, &b_min_mV);
-  cookedTree->SetBranchAddress("mean_mV",&mean_mV, &b_mean_mV);
-  cookedTree->SetBranchAddress("start_s",&start_s, &b_start_s);
-  cookedTree->SetBranchAddress("base_mV",&base_mV, &b_base_mV);
+  if( !RawFile || RawFile->empty() )
+    return;
   
-  nentries64_t = cookedTree->GetEntriesFast();
+  printf("\n ------------------------------ \n");
+  printf("\n Linking Raw Data \n");
   
-  if( nentries64_t > INT_MAX ){
-      fprintf(stderr,
-	      "\n Error, nentries = (%lld) > INT_MAX unsupported \n ",
-	      nentries64_t);
-      return;
+  // space separated (raw chain)
+  vector<string> rawFileNames;
+  istringstream  names(*RawFile);
+  
+  for( string name ; names >> name ; ){
+    printf("\n   %s ",name.c_str());
+    rawFileNames.push_back(name);
+  }
+  printf("\n");
+  
+  TFile * rawFile = TFile::Open(rawFileNames[0].c_str(),"READ");
+  
+  if( !rawFile || rawFile->IsZombie() ){
+    fprintf( stderr, "\n Error: cannot open raw file, waveforms not linked \n ");
+    delete rawFile;
+    return;
+  }
+  
+  char backend = GetBackend(rawFile,"T");
+  
+  delete rawFile;
+  
+#ifdef WITH_RNTUPLE
+  if( backend == 'N' ){
+    rawNTReader = new RawNTupleReader(rawFileNames[0]);
+    
+    if( !rawNTReader->IsOpen() ){
+      fprintf( stderr, "\n Error: cannot read raw RNTuple \n ");
+      delete rawNTReader;
+      rawNTReader = nullptr;
+    }
+    return;
+  }
+#endif
+  
+  if( backend != 'T' ){
+    fprintf( stderr, "\n Error: no raw tree 'T', waveforms not linked \n ");
+    return;
   }
-  else
-    nentries = (int)nentries64_t;
   
+  rawChain = new TChain("T");
+  
+  for( auto & name : rawFileNames )
+    rawChain->Add(name.c_str());
+  
+  rawChain->SetMakeClass(1);
+  
+  // only the ADC branch is read
+  SetBranchAddress_ADC(rawChain,&rawADC,&rawADC_arr,&b_rawADC);
   
   printf("\n ------------------------------ \n");
   
-  return;
+}
+
+short Invert_Negative_ADC_Pulses(short ADC){
+  
+  if(PulsePol=='N'){
+    ADC -= NADCBins/2;
+    ADC = -ADC;
+    ADC += NADCBins/2;
+  }
+  
+  return ADC;
+}
+
+bool DarkInput::LoadWaveform(){
+  
+  if( raw_entry < 0 )
+    return false;
+  
+  vector<short> * raw = nullptr;
+  
+#ifdef WITH_RNTUPLE
+  unsigned int HEAD[6];
+  
+  if( fRawNT && 
+      fRawNT->GetEntry(raw_entry,HEAD,&fRawADC_arr) )
+    raw = &fRawADC_arr;
+#endif
+  
+  if( fRawChain ){
+    Long64_t centry = fRawChain->LoadTree(raw_entry);
+    
+    if( centry < 0 || !fB_rawADC )
+      return false;
+    
+    fB_rawADC->GetEntry(centry);
+    raw = fRawADC;
+  }
+  
+  if( !raw || (int)raw->size() < NSamples )
+    return false;
+  
+  // scalars only cooked file
+  if( !ADC )
+    ADC = &fADC_lazy;
+  
+  ADC->resize(NSamples);
+  
+  // as cook_raw: masked samples set to
+  // the baseline, negative pulses flipped
+  float wave = base_mV*AmpGain/10.;
+  
+  if(PulsePol=='N')
+    wave = -wave;
+  
+  wave += Range_V*1000./2.;
+  
+  short masked = Invert_Negative_ADC_Pulses((short)roundf(wave/mVPerBin));
+  
+  for( int iSamp = 0 ; iSamp < NSamples ; iSamp++ ){
+    if( FirstMaskBin > 0 && iSamp >= FirstMaskBin )
+      (*ADC)[iSamp] = masked;
+    else
+      (*ADC)[iSamp] = Invert_Negative_ADC_Pulses(raw->at(iSamp));
+  }
+  
+  return true;
 }
 
 void PrintMetaData(){ 
@@ -694,17 +1129,60 @@ void PrintMetaData(){
 
 int main(int argc, char** argv){
 
-    const char* file = argv[1];
+    // meta data from the first file,
+    // cooked data from all of them
+    for( int iFile = 1 ; iFile < argc ; iFile++ ){
+      
+      // -v P|H plot output
+      if( string(argv[iFile]) == "-v" && iFile + 1 < argc ){
+	PlotOutput = *argv[++iFile];
+	continue;
+      }
+      
+      // -j analysis threads (0 one per core)
+      if( string(argv[iFile]) == "-j" && iFile + 1 < argc ){
+	long long nThreads = 0;
+	
+	if( !ReadNumber("-j",argv[++iFile],0,INT_MAX,&nThreads) ){
+	  fprintf( stderr, "\n Usage: dark Run*.root [-v P|H] [-j threads] \n ");
+	  return 1;
+	}
+	
+	SetNThreads((int)nThreads);
+	continue;
+      }
+      
+      inFileNames.push_back(argv[iFile]);
+    }
+    
+    if( inFileNames.empty() ){
+      fprintf( stderr, "\n Usage: dark Run*.root [-v P|H] [-j threads] \n ");
+      return 1;
+    }
+    
+    if( PlotOutput != 'P' && PlotOutput != 'H' ){
+      fprintf( stderr, "\n Error: unknown plot output \n ");
+      fprintf( stderr, "\n Setting to default ('P')  \n ");
+      PlotOutput = 'P';
+    }
+    
+    // batch nodes: no graphics start up
+    if( PlotOutput == 'H' )
+      gROOT->SetBatch(kTRUE);
+    
+    const char* file = inFileNames[0].c_str();
     inFile = new TFile(file,"READ");
     InitMeta();
     InitCooked();
-    InitCanvas();
+    InitRaw();
     PrintMetaData();
-    Noise();
-    Dark(10);
-    delete cookedTree;
+    bool complete = Noise() && Dark(10);
+    // summary file written ('H')
+    delete plots;
+    delete cookedReader;
+    delete rawChain;
     delete metaTree;
     delete inFile;
 
-    return 0;
+    return complete ? 0 : 1;
 }
@@ -12,13 +12,25 @@
 #include <TRandom3.h>
 #include <TLine.h>
 #include <TSystem.h>
+#include <TChain.h>
 
 #include <vector>
 #include <limits.h>
 #include <fstream>
+#include <sstream>
 
 #include <numeric>
-
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "DataStore.h"
+#include "HistWindow.h"
+#include "ReadNumber.h"
+#include "PlotStore.h"
+#include "WaveWorkspace.h"
 
 using namespace std;
 
@@ -46,6 +58,10 @@ int    Loc;
 char   Test;
 int    HVStep;
 
+// not in older cooked files
+char   PulsePol = 'N';
+string * RawFile = nullptr;
+
 TBranch * b_SampFreq     = 0;
 TBranch * b_NSamples     = 0;
 TBranch * b_NADCBins     = 0;
@@ -64,7 +80,8 @@ TBranch * b_HVStep       = 0;
 
 //--------------------
 // cooked data
-TTree * cookedTree;
+// (TTree or RNTuple)
+CookedReader * cookedReader = nullptr;
 
 // Input 
 vector <short> * ADC = 0;   
@@ -74,14 +91,122 @@ float min_mV;
 float mean_mV;
 float start_s;
 float base_mV;
+// raw tree entry, -1 if not linked
+Long64_t raw_entry = -1;
+
+//--------------------
+// raw data 'T' linked from the cooked tree
+// (Meta_Data RawFile), waveforms are read
+// only for events that need them
+TChain        * rawChain  = nullptr;
+TBranch       * b_rawADC  = nullptr;
+vector<short> * rawADC    = nullptr;
+vector<short>   rawADC_arr;
+#ifdef WITH_RNTUPLE
+RawNTupleReader * rawNTReader = nullptr;
+#endif
+
+//--------------------
+// one thread's cooked input and linked raw 
+// data, opened again from the same files 
+// (none of the readers are thread safe)
+class DarkInput {
+public:
+  DarkInput();
+  ~DarkInput();
+  
+  bool IsOpen();
+  // scalars only
+  int  GetEntry(Long64_t entry);
+  
+  // reads this entry's cooked waveform into
+  // ADC (after the cuts on the scalars), false 
+  // if the cooked file has no ADC branch or
+  // this entry's waveform was not kept
+  // (cook_raw -a S or -a P)
+  bool HasWaveform();
+  
+  // cooks this entry's raw waveform into ADC 
+  // (flip and mask as cook_raw), false if
+  // there is no linked raw data
+  bool LoadWaveform();
+  
+  vector <short> * ADC = 0;
+  float peak_mV   = 0.;
+  short peak_samp = 0;
+  float min_mV    = 0.;
+  float mean_mV   = 0.;
+  float start_s   = 0.;
+  float base_mV   = 0.;
+  // raw tree entry, -1 if not linked
+  Long64_t raw_entry = -1;
+  
+private:
+  TFile         * fFile     = nullptr;
+  CookedReader  * fCooked   = nullptr;
+  Long64_t        fEntry    = -1;
+  
+  TChain        * fRawChain = nullptr;
+  TBranch       * fB_rawADC = nullptr;
+  vector<short> * fRawADC   = nullptr;
+  vector<short>   fRawADC_arr;
+#ifdef WITH_RNTUPLE
+  RawNTupleReader * fRawNT  = nullptr;
+#endif
+  // used if the cooked file has no ADC branch
+  vector<short>   fADC_lazy;
+};
+
+//--------------------
+// Parallel analysis (-j)
+// Noise() and Dark() read entry ranges on
+// NThreads threads, each with its own input,
+// histograms and counters, summed at the end.
+// Event lists are kept per range and written
+// in entry order, as in a serial run.
+
+int  NThreads = 1;
+
+// < 1 for one per core
+void SetNThreads(int nThreads);
+
+// entries [first, first + n) and the
+// events listed from them
+struct DarkRange {
+  Long64_t first = 0;
+  Long64_t n     = 0;
+  
+  vector<Long64_t> hits;      // dark_hits.csv
+  vector<Long64_t> rejected;  // rejected_waveforms.csv
+  vector<Long64_t> unchecked; // unchecked_hits.csv
+  
+  bool done = false;
+};
+
+// whole clusters of a cooked tree 
+// (no basket is read by two threads)
+vector<DarkRange> GetDarkRanges();
+
+// process(iThread,input,range) each range, up
+// to NThreads at a time, with merge(range) 
+// called on this thread in entry order;
+// false, with no more merges, if an input
+// failed to open or process returned false
+// (an entry not read)
+bool ForEachRange(vector<DarkRange> & ranges,
+		  function<bool(int,DarkInput&,DarkRange&)> process,
+		  function<void(DarkRange&)> merge);
+
+// each thread fills a double copy, summed
+// in double and added to the histogram once:
+// integer counts are exact to 2^53 (a TH1F
+// bin to 2^24), so the bin contents do not
+// depend on the number of threads
+TH1D * ThreadHist(TH1F * hist, int iThread);
+TH2D * ThreadHist(TH2F * hist, int iThread);
+
+void AddThreadHist(TH1 * hist, TH1 * threadHist);
 
-TBranch * b_ADC = 0;
-TBranch * b_peak_mV  = 0;  
-TBranch * b_peak_samp = 0;  
-TBranch * b_min_mV  = 0;  
-TBranch * b_mean_mV = 0;  
-TBranch * b_start_s = 0;  
-TBranch * b_base_mV = 0;  
 
 void InitCanvas(float w = 1000.,
         float h = 800.);
@@ -89,6 +214,9 @@ void DeleteCanvas();
 
 void  InitMeta();
 void  InitCooked();
+void  InitRaw();
+
+short Invert_Negative_ADC_Pulses(short ADC);
 
 string GetFileID();
 
@@ -114,6 +242,15 @@ TH1F * hPeak_Cooked = nullptr;
 
 TH2F * hMin_Peak_Cooked = nullptr;
 
+// one thread's copies
+struct NoiseHists {
+  TH1D * hMean     = nullptr;
+  TH1D * hPPV      = nullptr;
+  TH1D * hMin      = nullptr;
+  TH1D * hPeak     = nullptr;
+  TH2D * hMin_Peak = nullptr;
+};
+
 //void  SetStyle();
 void  SetTest(char Test);
 char  GetTest();
@@ -121,7 +258,7 @@ char  GetTest();
 void  SetRun(int Run);
 int   GetRun();
 
-void  Noise();
+bool  Noise();
 void  InitNoise();
 void  SaveNoise(string outFolder = "./Plots/Noise/");
 
@@ -140,20 +277,53 @@ bool  HasLowNoise(float min_mV,float peak_mV,
 TH1F * hD_Peak = nullptr;
 TH2F * hD_Min_Peak = nullptr;
 
+// one thread's counts, histograms
+// and waveform buffers
+struct DarkThread {
+  Long64_t nDark       = 0;
+  Long64_t nDark_noise = 0;
+  Long64_t rejected    = 0;
+  Long64_t rise_rej    = 0;
+  Long64_t peak_low    = 0;
+  Long64_t peak_high   = 0;
+  // passed the scalar cuts, no waveform
+  // for the other checks (not counted)
+  Long64_t unchecked   = 0;
+  
+  TH1D * hD_Peak     = nullptr;
+  TH2D * hD_Min_Peak = nullptr;
+  
+  WaveWorkspace workspace;
+};
+
 double base_average(int iEntry);
-std::pair<double,std::vector<double>> base(int iEntry);
 double average;
-int peak_rise(float thesh_mV = 10., int nbins = 10);
-void  Dark(float thresh_mV = 10.);
+
+// for WaveWorkspace::Init
+DarkConstants GetDarkConstants();
+
+bool  Dark(float thresh_mV = 10.);
 void  InitDark();
 void  SaveDark(string outFolder = "./Plots/Dark/");
 
-// only accommodating int size here
-Long64_t nentries64_t; // dummy
-int      nentries;
+Long64_t nentries;
+
+// cooked files of one run 
+// (cook_raw -o parts)
+vector<string> inFileNames;
 
 TCanvas * canvas = nullptr;
 
+// monitoring plots
+// 'P' PDFs (default)
+// 'H' histograms only, no canvas, saved to
+//     ./Plots/<FileID>_dark.root for 
+//     render_plots
+char        PlotOutput = 'P';
+PlotStore * plots      = nullptr;
+
+PlotStore * GetPlots();
+
 void  Set_THF_Params(float *,float *,float *, int *);
 
 //#endif
@@ -0,0 +1,259 @@
+/***************************************************
+ * A program to draw monitoring plots saved as
+ * histograms (cook_raw -v H, dark -v H)
+ *
+ * Purpose
+ *  Batch jobs write their monitoring histograms
+ *  to one summary file per run, with no canvas
+ *  (see $WM_COMMON/PlotStore.h). This draws the
+ *  PDFs of any number of summary files later,
+ *  only when they are wanted, exactly as they
+ *  would have been drawn in the job.
+ *
+ * How to build
+ *  $ make
+ *
+ * How to run
+ *  $ render_plots ./Plots/<FileID>_cook_raw.root
+ *
+ *  all runs, 8 files at a time
+ *  $ render_plots -j 8 $(find /path/to/data -name "*_dark.root")
+ *
+ * Output
+ *  PDFs in the summary file's folder,
+ *  (e.g. ./Plots/DAQ/hTrigFreq.pdf)
+ *
+ *  Drawing is not thread safe so files are
+ *  drawn in parallel by -j worker processes
+ *  (default: one per core, at most one per file)
+ *
+ */
+
+#include <TROOT.h>
+#include <TFile.h>
+#include <TH1.h>
+#include <TCanvas.h>
+#include <TNamed.h>
+#include <TObjArray.h>
+#include <TStyle.h>
+#include <TColor.h>
+#include <TSystem.h>
+#include <TError.h>
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "wmStyle.C"
+#include "PlotStore.h"
+#include "ReadNumber.h"
+
+using namespace std;
+
+void PrintUsage();
+void SetStyle(string style);
+bool RenderFile(string summaryPath);
+
+int main(int argc, char** argv){
+
+  int nWorkers = 0;
+
+  vector<string> inNames;
+
+  for ( int i = 1; i < argc ; i++ ) {
+    if( argv[i][0] != '-' )
+      inNames.push_back(argv[i]);
+    else if( i+1 < argc && string(argv[i]) == "-j" ){
+      long long value = 0;
+      
+      if( !ReadNumber("-j",argv[++i],0,INT_MAX,&value) ){
+	PrintUsage();
+	return -1;
+      }
+      
+      nWorkers = (int)value;
+    }
+    else {
+      PrintUsage();
+      return -1;
+    }
+  }
+
+  int nFiles = (int)inNames.size();
+
+  if( nFiles == 0 ){
+    PrintUsage();
+    return -1;
+  }
+
+  if( nWorkers < 1 )
+    nWorkers = (int)thread::hardware_concurrency();
+  if( nWorkers < 1 )
+    nWorkers = 1;
+  if( nWorkers > nFiles )
+    nWorkers = nFiles;
+
+  printf("\n  Drawing %d files with %d workers \n",
+	 nFiles, nWorkers);
+
+  // each worker draws every nWorkers-th file
+  vector<pid_t> workers;
+
+  for( int iWorker = 0; iWorker < nWorkers; iWorker++ ){
+
+    pid_t pid = fork();
+
+    if( pid < 0 ){
+      fprintf( stderr, "\n Error: cannot start worker \n ");
+      break;
+    }
+
+    if( pid == 0 ){
+      gROOT->SetBatch(kTRUE);
+
+      // one line per PDF otherwise
+      gErrorIgnoreLevel = kWarning;
+
+      int nFailed = 0;
+
+      for( int iFile = iWorker; iFile < nFiles; iFile += nWorkers )
+	if( !RenderFile(inNames[iFile]) )
+	  nFailed++;
+
+      _exit( nFailed > 0 ? 1 : 0 );
+    }
+
+    workers.push_back(pid);
+  }
+
+  bool failed = ( (int)workers.size() < nWorkers );
+
+  for( pid_t pid : workers ){
+    int status = 0;
+    waitpid(pid,&status,0);
+
+    if( !WIFEXITED(status) || WEXITSTATUS(status) != 0 )
+      failed = true;
+  }
+
+  if( failed ){
+    fprintf( stderr, "\n Error: not all plots drawn \n ");
+    return -1;
+  }
+
+  return 1;
+}
+
+bool RenderFile(string summaryPath){
+
+  TFile * file = TFile::Open(summaryPath.c_str(),"READ");
+
+  if( !file || file->IsZombie() ){
+    fprintf( stderr, "\n Error: cannot open %s \n ",summaryPath.c_str());
+    delete file;
+    return false;
+  }
+
+  TObjArray * plots = nullptr;
+  TNamed    * style = nullptr;
+
+  file->GetObject("plots",plots);
+  file->GetObject("style",style);
+
+  if( !plots ){
+    fprintf( stderr, "\n Error: no plots in %s \n ",summaryPath.c_str());
+    delete file;
+    return false;
+  }
+
+  if( style )
+    SetStyle(style->GetTitle());
+
+  // PDF paths are relative to here
+  string folder;
+  size_t slash = summaryPath.rfind('/');
+  if( slash != string::npos )
+    folder = summaryPath.substr(0,slash + 1);
+
+  TCanvas * canvas = new TCanvas();
+
+  int nDrawn = 0;
+
+  for( TObject * object : *plots ){
+
+    string pdfPath = folder + object->GetName();
+
+    // histogram name then pad options
+    istringstream title(object->GetTitle());
+    string histName, padOptions;
+
+    title >> histName;
+    getline(title,padOptions);
+
+    TH1 * hist = nullptr;
+    file->GetObject(histName.c_str(),hist);
+
+    if( !hist ){
+      fprintf( stderr, "\n Error: no histogram %s in %s \n ",
+	       histName.c_str(),summaryPath.c_str());
+      continue;
+    }
+
+    gSystem->mkdir(gSystem->DirName(pdfPath.c_str()),true);
+
+    DrawPlot(canvas,hist,pdfPath,padOptions);
+
+    nDrawn++;
+  }
+
+  printf("\n  %s \n   %d of %d plots drawn \n",
+	 summaryPath.c_str(),nDrawn,plots->GetEntries());
+
+  bool success = ( nDrawn == plots->GetEntries() );
+
+  delete canvas;
+  delete file;
+
+  return success;
+}
+
+// as the program that made the plots
+// (TCooker::SetStyle for wmStyle)
+void SetStyle(string style){
+
+  if( style != "wmStyle" ){
+    if( gROOT->GetStyle(style.c_str()) )
+      gROOT->SetStyle(style.c_str());
+    return;
+  }
+
+  TStyle *wmStyle = GetwmStyle();
+
+  const int NCont = 255;
+  const int NRGBs = 5;
+
+  // Color scheme for 2D plotting with a better defined scale
+  double stops[NRGBs] = { 0.00, 0.34, 0.61, 0.84, 1.00 };
+  double red[NRGBs]   = { 0.00, 0.00, 0.87, 1.00, 0.51 };
+  double green[NRGBs] = { 0.00, 0.81, 1.00, 0.20, 0.00 };
+  double blue[NRGBs]  = { 0.51, 1.00, 0.12, 0.00, 0.00 };
+  TColor::CreateGradientColorTable(NRGBs, stops, red, green, blue, NCont);
+
+  wmStyle->SetNumberContours(NCont);
+
+  gROOT->SetStyle("wmStyle");
+  gROOT->ForceStyle();
+}
+
+void PrintUsage(){
+  cerr << " Usage: " << endl;
+  cerr << " render_plots /path/to/Plots/<FileID>_cook_raw.root [more summary files] [-j workers] "
+       << endl;
+  cerr << " -j number of files drawn at the same time (default: number of cores) "
+       << endl;
+}
@@ -12,15 +12,11 @@ FILE_NAME=$(find . -maxdepth 1 -name "wave_*.dat" )
 
 FILE_PATH=${DIR_PATH}${FILE_NAME}
 
-${WM_CONVERT}/dat_to_root ${FILE_PATH}
-
-echo " ------------------------------"
-date 
-echo " ------------------------------"
-
 mkdir -p ./Plots/DAQ/
 
-${WM_COOK}/cook_raw ${FILE_PATH}.root
+# cook straight from the binary file
+# (add '-r Y' to keep the raw root file)
+${WM_COOK}/cook_raw ${FILE_PATH}
 
 echo " ------------------------------"
 date 
@@ -9,6 +9,7 @@ echo ${WM_CODE}
 export WM_CONVERT=${WM_CODE}/Binary_Conversion/
 export WM_COOK=${WM_CODE}/Cooking/
 export WM_DARK=${WM_CODE}/Dark/
+export WM_PLOT=${WM_CODE}/Plotting/
 export WM_COMMON=${WM_CODE}/Common_Tools/
 
 # headers
@@ -20,6 +21,7 @@ export PATH=${PATH}:${WM_CODE}
 export PATH=${PATH}:${WM_CONVERT}
 export PATH=${PATH}:${WM_COOK}
 export PATH=${PATH}:${WM_DARK}
+export PATH=${PATH}:${WM_PLOT}
 
 # libraries
 if [[ "$OSTYPE" == "linux-gnu" ]]; then